@@ -0,0 +1,138 @@
+#include "Core/ThreadPool.hpp"
+
+#include <algorithm>
+
+namespace Gate {
+
+  namespace {
+    // Index of the queue owned by the current thread, the last one belongs to callers.
+    thread_local u32 sQueueIndex = UINT32_MAX;
+
+    // How many times a worker checks for new work before going to sleep.
+    static const constexpr u32 SPIN_COUNT = 4096;
+  }
+
+  ThreadPool& ThreadPool::get() {
+#ifdef GATE_PLATFORM_WEB
+    static ThreadPool pool(0);
+#else
+    static ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()) - 1);
+#endif
+    return pool;
+  }
+
+  ThreadPool::ThreadPool(u32 workerCount)
+    : mQueues(workerCount + 1)
+  {
+    for (u32 i = 0; i < workerCount; ++i) {
+      mWorkers.emplace_back([this, i] { work(i); });
+    }
+  }
+
+  ThreadPool::~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mStop = true;
+      mEpoch++;
+    }
+    mCondition.notify_all();
+    for (auto& worker : mWorkers) {
+      worker.join();
+    }
+  }
+
+  void ThreadPool::parallelFor(u32 count, u32 grain, const RangeFunction& function) {
+    if (count == 0) {
+      return;
+    }
+    grain = std::max(1u, grain);
+
+    const bool isWorker = sQueueIndex != UINT32_MAX && sQueueIndex < mWorkers.size();
+    if (mWorkers.empty() || count <= grain || isWorker || !mSubmitMutex.try_lock()) {
+      function(0, count);
+      return;
+    }
+
+    // Deal the chunks round-robin, so every queue starts with its share of work.
+    const u32 callerIndex = (u32)mWorkers.size();
+    const u32 chunkCount = (count + grain - 1) / grain;
+    mFunction = &function;
+    mRemaining.store(chunkCount, std::memory_order_relaxed);
+    for (u32 chunk = 0; chunk < chunkCount; ++chunk) {
+      auto& queue = mQueues[chunk % mQueues.size()];
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      queue.ranges.push_back(Range{chunk * grain, std::min(count, (chunk + 1) * grain)});
+    }
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mEpoch++;
+    }
+    mCondition.notify_all();
+
+    u32 previousIndex = sQueueIndex;
+    sQueueIndex = callerIndex;
+    run(callerIndex);
+    sQueueIndex = previousIndex;
+
+    while (mRemaining.load(std::memory_order_acquire) != 0) {
+      std::this_thread::yield();
+    }
+    mFunction = nullptr;
+    mSubmitMutex.unlock();
+  }
+
+  void ThreadPool::work(u32 index) {
+    sQueueIndex = index;
+    u64 epoch = 0;
+    while (true) {
+      // Spin for a while, jobs usually come in bursts (e.g. one per level).
+      for (u32 i = 0; i < SPIN_COUNT && mEpoch.load(std::memory_order_acquire) == epoch; ++i) {
+        std::this_thread::yield();
+      }
+      {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mCondition.wait(lock, [&] { return mStop || mEpoch.load(std::memory_order_relaxed) != epoch; });
+        if (mStop) {
+          return;
+        }
+        epoch = mEpoch.load(std::memory_order_relaxed);
+      }
+      run(index);
+    }
+  }
+
+  void ThreadPool::run(u32 index) {
+    Range range;
+    while (pop(index, range) || steal(index, range)) {
+      (*mFunction)(range.begin, range.end);
+      mRemaining.fetch_sub(1, std::memory_order_acq_rel);
+    }
+  }
+
+  bool ThreadPool::pop(u32 index, Range& range) {
+    auto& queue = mQueues[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.ranges.empty()) {
+      return false;
+    }
+    range = queue.ranges.back();
+    queue.ranges.pop_back();
+    return true;
+  }
+
+  bool ThreadPool::steal(u32 index, Range& range) {
+    const u32 queueCount = (u32)mQueues.size();
+    for (u32 i = 1; i < queueCount; ++i) {
+      auto& queue = mQueues[(index + i) % queueCount];
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      if (queue.ranges.empty()) {
+        continue;
+      }
+      range = queue.ranges.front();
+      queue.ranges.pop_front();
+      return true;
+    }
+    return false;
+  }
+
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "Core/Type.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Gate {
+
+  // A pool of worker threads, every worker owns a queue of ranges and steals
+  // from the others once its own queue is empty.
+  class ThreadPool {
+  public:
+    using RangeFunction = std::function<void(u32 begin, u32 end)>;
+
+  public:
+    // The shared pool, with one worker less than the hardware threads (the caller works too).
+    static ThreadPool& get();
+
+    ThreadPool(u32 workerCount);
+    DISALLOW_MOVE_AND_COPY(ThreadPool);
+    ~ThreadPool();
+
+    // Including the calling thread.
+    inline u32 getThreadCount() const { return (u32)mWorkers.size() + 1; }
+
+    // Splits [0, count) into chunks of at most grain elements and runs them on the pool
+    // and the calling thread. Returns once every chunk is done, so it acts as a barrier.
+    //
+    // NOTE: Calls from a worker thread, or while the pool is busy, are run inline.
+    void parallelFor(u32 count, u32 grain, const RangeFunction& function);
+
+  private:
+    struct Range {
+      u32 begin;
+      u32 end;
+    };
+
+    struct Queue {
+      std::mutex mutex;
+      std::deque<Range> ranges;
+    };
+
+  private:
+    void work(u32 index);
+    void run(u32 index);
+    bool pop(u32 index, Range& range);
+    bool steal(u32 index, Range& range);
+
+  private:
+    std::vector<std::thread> mWorkers;
+    std::vector<Queue> mQueues;
+
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    std::atomic<u64> mEpoch{0};
+    bool mStop = false;
+
+    std::mutex mSubmitMutex;
+    const RangeFunction* mFunction = nullptr;
+    std::atomic<u32> mRemaining{0};
+  };
+
+}
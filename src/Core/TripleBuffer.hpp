@@ -0,0 +1,47 @@
+#pragma once
+
+#include "Core/Type.hpp"
+
+#include <atomic>
+
+namespace Gate {
+
+  // Hands values from a single writer thread to a single reader thread without locks.
+  //
+  // The writer fills its buffer and publishes it by swapping it with the spare one, the reader
+  // swaps its buffer with the spare one when a new value was published. Neither side ever waits,
+  // the reader always gets the latest published value and intermediate ones are skipped.
+  template<typename T>
+  class TripleBuffer {
+  public:
+    inline T& getWriteBuffer() { return mBuffers[mWrite]; }
+
+    inline void publish() {
+      const u8 spare = mSpare.exchange(u8(mWrite | FRESH), std::memory_order_acq_rel);
+      mWrite = spare & INDEX;
+    }
+
+    // Returns true if a newer value was published since the last call.
+    inline bool acquire() {
+      if ((mSpare.load(std::memory_order_relaxed) & FRESH) == 0) {
+        return false;
+      }
+      const u8 spare = mSpare.exchange(mRead, std::memory_order_acq_rel);
+      mRead = spare & INDEX;
+      return true;
+    }
+
+    inline const T& getReadBuffer() const { return mBuffers[mRead]; }
+
+  private:
+    static const constexpr u8 INDEX = 0x3;
+    static const constexpr u8 FRESH = 0x4;
+
+  private:
+    T mBuffers[3];
+    u8 mWrite = 0;
+    u8 mRead = 1;
+    std::atomic<u8> mSpare{2};
+  };
+
+}
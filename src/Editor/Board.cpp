@@ -5,6 +5,7 @@
 
 #include "Core/OpenGL.hpp"
 
+#include "Editor/Scheduler.hpp"
 #include "Editor/Wire.hpp"
 
 namespace Gate {
@@ -163,7 +164,7 @@ namespace Gate {
       mMiniMapFrameBuffer->bind();
 
       auto oldSize = config.grid.cell.size;
-      config.grid.cell.size = getCurrentChip().getOptimalCellSize();
+      config.grid.cell.size = getCurrentChip().getOptimalCellSize(Application::getWindow().getWidth(), Application::getWindow().getHeight());
       getCurrentChip().render(renderer);
       config.grid.cell.size = oldSize;
 
@@ -206,19 +207,19 @@ namespace Gate {
     const auto last_element = mChips.size() - 1;
     if (mIndex == 0) {
       mIndex = last_element;
-      return;
+    } else {
+      mIndex--;
     }
-
-    mIndex--;
+    updateBackground();
   }
   void Board::moveCurrentChipUp() {
     const auto last_element = mChips.size() - 1;
     if (mIndex == last_element) {
       mIndex = 0;
-      return;
+    } else {
+      mIndex++;
     }
-
-    mIndex++;
+    updateBackground();
   }
   
   Chip& Board::getCurrentChip() {
@@ -233,16 +234,53 @@ namespace Gate {
   void Board::pushChip(Chip::Handle chip) {
     mIndex = mChips.size();
     mChips.push_back(std::move(chip));
+    updateBackground();
   }
   void Board::pushNewChip() {
     mIndex = mChips.size();
     mChips.push_back(Chip::create(mIndex));
+    updateBackground();
   }
 
   void Board::tick() {
     getCurrentChip().tick();
     mMiniMapTexture = nullptr;
   }
+  void Board::tickAll() {
+    Scheduler(mChips).run([](u32, Chip& chip) {
+      chip.tick();
+    });
+    mMiniMapTexture = nullptr;
+  }
+  void Board::setBackground(bool enable) {
+    mBackground = enable;
+    updateBackground();
+  }
+  void Board::updateBackground() {
+    for (u32 i = 0; i < mChips.size(); ++i) {
+      if (mBackground && i == mIndex) {
+        mChips[i]->startBackground();
+      } else {
+        mChips[i]->stopBackground();
+      }
+    }
+    mMiniMapTexture = nullptr;
+  }
+  void Board::sync() {
+    for (auto& chip : mChips) {
+      if (chip->sync()) {
+        mMiniMapTexture = nullptr;
+      }
+    }
+  }
+  void Board::updateClocks(f64 budgetSeconds) {
+    for (auto& chip : mChips) {
+      if (chip->isClockRunning()) {
+        chip->updateClocks(budgetSeconds);
+        mMiniMapTexture = nullptr;
+      }
+    }
+  }
   bool Board::pushComponent(Component* component) {
     mMiniMapTexture = nullptr;
     return getCurrentChip().pushComponent(component);
@@ -259,13 +297,34 @@ namespace Gate {
     mMiniMapTexture = nullptr;
     return getCurrentChip().pushWire(wire);
   }
-  bool Board::click(Point position) {
+  bool Board::click(Point position, Chip::State* previous) {
+    mMiniMapTexture = nullptr;
+    return getCurrentChip().click(position, previous);
+  }
+  bool Board::click(u32 id, Chip::State* previous) {
     mMiniMapTexture = nullptr;
-    return getCurrentChip().click(position);
+    return getCurrentChip().click(id, previous);
   }
-  bool Board::click(u32 id) {
+
+  std::vector<Chip::State> Board::snapshot() {
+    std::vector<Chip::State> states;
+    states.reserve(mChips.size());
+    for (auto& chip : mChips) {
+      states.push_back(chip->snapshot());
+    }
+    return states;
+  }
+  bool Board::restore(const std::vector<Chip::State>& states) {
+    if (states.size() != mChips.size()) {
+      Logger::warn("Board: the state has %zu chips, expected %zu", states.size(), mChips.size());
+      return false;
+    }
+    bool restored = true;
+    for (usize i = 0; i < mChips.size(); ++i) {
+      restored &= mChips[i]->restore(states[i]);
+    }
     mMiniMapTexture = nullptr;
-    return getCurrentChip().click(id);
+    return restored;
   }
 
   bool Board::isValidPosition(Point point) {
@@ -289,7 +348,7 @@ namespace Gate::Serializer {
     node["chips"] = chips;
     return node;
   }
-  bool Convert<Board>::decode(const Node& node, Board& value) {
+  bool Convert<Board>::decode(const Node& node, Board& value, const String& directory) {
     if (!node.isObject()) return false;
 
     auto* chipsNode  = node.get("chips");
@@ -299,7 +358,7 @@ namespace Gate::Serializer {
     u32 count = 0;
     for (auto& chip : chipsArray) {
       Chip::Handle chipValue = Chip::create(count);
-      if (!Convert<Chip>::decode(chip, *chipValue, value)) return false;
+      if (!Convert<Chip>::decode(chip, *chipValue, value.getChips(), directory)) return false;
       value.pushChip(std::move(chipValue));
 
       count++;
@@ -34,12 +34,31 @@ namespace Gate {
     void onResize(u32 width, u32 height);
 
     void tick();
+
+    // Ticks every chip, the ones that don't contain each other concurrently (see Scheduler).
+    void tickAll();
+
+    // Simulates the current chip on its own thread (see Chip::startBackground()), it follows
+    // the current chip. The other chips are simulated on the render thread.
+    void setBackground(bool enable);
+    bool isBackground() const { return mBackground; }
+
+    // Shows the latest states of the background simulations, called once per frame.
+    void sync();
+
+    // Advances the free-running clocks of the chips that aren't simulated in the background.
+    void updateClocks(f64 budgetSeconds);
     bool pushComponent(Component* component);
     void removeComponent(Point position);
     void removeWire(Point position);
     WirePushState pushWire(Wire wire);
-    bool click(Point position);
-    bool click(u32 id);
+    // See Chip::click().
+    bool click(Point position, Chip::State* previous = nullptr);
+    bool click(u32 id, Chip::State* previous = nullptr);
+
+    // Simulation state of every chip, see Chip::snapshot().
+    std::vector<Chip::State> snapshot();
+    bool restore(const std::vector<Chip::State>& states);
 
     void cycleMiniMapPositions();
     void invalidateMiniMap(Renderer2D& renderer);
@@ -57,10 +76,12 @@ namespace Gate {
     void renderMiniMap(Renderer2D& renderer);
     void createMiniMapFrameBuffer();
     MiniMap calculateMiniMapLocationAndSize();
+    void updateBackground();
 
   private:
     u32 mIndex = 0;
     std::vector<Chip::Handle> mChips;
+    bool mBackground = false;
 
     // Grid drawing & caching
     FrameBuffer::Handle mGridFrameBuffer;
@@ -78,7 +99,8 @@ namespace Gate::Serializer {
   template<>
   struct Convert<Board> {
     static Node encode(Board& value);
-    static bool decode(const Node& node, Board& value);
+    // The directory of the board file, the files it references are relative to it.
+    static bool decode(const Node& node, Board& value, const String& directory);
   };
 
 }
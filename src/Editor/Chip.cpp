@@ -1,7 +1,8 @@
 #include "Editor/Chip.hpp"
-#include "Application.hpp"
+#include "Utils/File.hpp"
+#include "Simulation/Optimizer.hpp"
 
-#include <queue>
+#include <unordered_map>
 
 namespace Gate {
   
@@ -23,104 +24,85 @@ namespace Gate {
     }
   }
 
-  bool Chip::click(Point position) {
-    bool interacted = false;
-    for (auto* component : mComponents) {
-      if (!component) {
-        continue;
-      }
-      if (component->getPosition() == position) {
-        component->click();
-        interacted = true;
-        tick();
-        break;
+  bool Chip::click(Point position, State* previous) {
+    for (u32 i = 0; i < mComponents.size(); ++i) {
+      auto* component = mComponents[i];
+      if (component && component->getPosition() == position) {
+        return click(i, previous);
       }
     }
-    return interacted;
+    return false;
   }
 
-  bool Chip::click(u32 id) {
-    bool interacted = false;
-    if (id < mComponents.size()) {
-      mComponents[id]->click();
-      interacted = true;
-      tick();
+  bool Chip::click(u32 id, State* previous) {
+    if (id >= mComponents.size() || !mComponents[id]) {
+      return false;
     }
-    return interacted;
+    const auto type = mComponents[id]->getType();
+    if (previous && type == Component::Type::Switch) {
+      *previous = snapshot();
+    }
+    mComponents[id]->click();
+    // The period of a clock and the contents of a ROM are compiled into the chip.
+    if (type == Component::Type::Clock || type == Component::Type::Rom) {
+      invalidate();
+    }
+    propagate(id);
+    return true;
   }
-  void Chip::calculateOptimalCellSize(Point position) {
-    auto wWidth  = Application::getWindow().getWidth();
-    auto wHeight = Application::getWindow().getHeight();
-
-    const auto padding = 1;
+  void Chip::extend(Point position) {
+    mExtent.x = std::max(mExtent.x, position.x);
+    mExtent.y = std::max(mExtent.y, position.y);
+  }
+  u32 Chip::getOptimalCellSize(u32 width, u32 height) const {
+    const u32 padding = 1;
 
-    if (position.x * mOptimalCellSize >= wWidth) {
-      mOptimalCellSize = wWidth / position.x - padding;
+    u32 size = mOptimalCellSize;
+    if (mExtent.x != 0 && mExtent.x * size >= width) {
+      size = width / mExtent.x;
+      size = size > padding ? size - padding : 0;
     }
-    if (position.y * mOptimalCellSize >= wHeight) {
-      mOptimalCellSize = wHeight / position.y - padding;
+    if (mExtent.y != 0 && mExtent.y * size >= height) {
+      size = height / mExtent.y;
+      size = size > padding ? size - padding : 0;
     }
 
-    if (mOptimalCellSize < 2) {
-      mOptimalCellSize = 2;
+    if (size < 2) {
+      size = 2;
     }
+    return size;
   }
-  ConnectionState Chip::getConnectionState(Connection& connection) {
-    switch (connection.type) {
-      case Connection::Type::Component: {
-        auto* component = mComponents[connection.componentIndex];
-        auto& pins = component->getOutputPins();
-        auto& pin = pins.at(connection.index);
-        return ConnectionState(pin.active, pin.visited);
-      } break;
-      case Connection::Type::Wire: {
-        auto& wire = mWires[connection.index];
-        if (wire.free) {
-          GATE_UNREACHABLE("We shouldn't access freed wires!");
-        }
-        return ConnectionState(wire.active, wire.visited);
-      } break;
-    }
-    GATE_UNREACHABLE("");
-  }
-  ConnectionResult Chip::pushWireConnection(Point position, u32 wireIndex) {
-    auto connection = Connection {
-      Connection::Type::Wire,
-      wireIndex,
-    };
-    u32 connectionIndex;
+  u32 Chip::pushConnection(Point position) {
     if (auto it = mConnectionsIndexByPoint.find(position); it != mConnectionsIndexByPoint.end()) {
-      connectionIndex = it->second;
-      mConnections[connectionIndex].push_back(connection);
-    } else {
-      connectionIndex = (u32)mConnections.size();
-      mConnections.push_back({});
-      mConnections[connectionIndex].push_back(connection);
-      mConnectionsIndexByPoint[position] = connectionIndex;
+      return it->second;
     }
+    u32 connectionIndex = mConnectionPointCount++;
+    mConnectionsIndexByPoint[position] = connectionIndex;
     return connectionIndex;
   }
-  ConnectionResult Chip::pushComponentConnection(Point position, u32 componentIndex, u32 pinIndex) {
-    auto connection = Connection {
-      Connection::Type::Component,
-      pinIndex,
-      componentIndex
-    };
-    u32 connectionIndex;
-    if (auto it = mConnectionsIndexByPoint.find(position); it != mConnectionsIndexByPoint.end()) {
-      connectionIndex = it->second;
-      // TODO: check if its output pin
-      if (false) {
-        return {};
+
+  void Chip::compactConnections() {
+    // The points are numbered again from the pins and wires that are left, so the points of
+    // the removed ones don't take part in groupConnections().
+    mConnectionsIndexByPoint.clear();
+    mConnectionPointCount = 0;
+    for (auto* component : mComponents) {
+      if (!component) {
+        continue;
+      }
+      for (auto& pin : component->getInputPins()) {
+        pin.connectionIndex = pushConnection(pin.position);
+      }
+      for (auto& pin : component->getOutputPins()) {
+        pin.connectionIndex = pushConnection(pin.position);
+      }
+    }
+    for (auto& wire : mWires) {
+      if (!wire.free) {
+        wire.connectionIndexes[0] = pushConnection(wire.from);
+        wire.connectionIndexes[1] = pushConnection(wire.to);
       }
-      mConnections[connectionIndex].push_back(connection);
-    } else {
-      connectionIndex = (u32)mConnections.size();
-      mConnections.push_back({});
-      mConnections[connectionIndex].push_back(connection);
-      mConnectionsIndexByPoint[position] = connectionIndex;
     }
-    return connectionIndex;
   }
 
   bool Chip::pushComponent(Component* component) {
@@ -144,31 +126,17 @@ namespace Gate {
     }
     u32 componentIndex = freeSlot;
     
-    // TODO: refactor to remove code duplication
-    auto& inputPins = component->getInputPins();
-    for (u32 i = 0; i < inputPins.size(); ++i) {
-      auto& pin = inputPins[i];      
-      auto[successful, connectionIndex] = pushComponentConnection(pin.position, componentIndex, i);
-      if (!successful) {
-        GATE_TODO("Fix invalid pin connection!");
-      }
-      mConnectionsIndexByPoint[pin.position] = connectionIndex;
-      pin.connectionIndex = connectionIndex;
-    }
-    auto& outputPins = component->getOutputPins();
-    for (u32 i = 0; i < outputPins.size(); ++i) {
-      auto& pin = outputPins[i];      
-      auto[successful, connectionIndex] = pushComponentConnection(pin.position, componentIndex, i);
-      if (!successful) {
-        GATE_TODO("Fix invalid pin connection!");
-      }
-      mConnectionsIndexByPoint[pin.position] = connectionIndex;
-      pin.connectionIndex = connectionIndex;
+    for (auto& pin : component->getInputPins()) {
+      pin.connectionIndex = pushConnection(pin.position);
+    }
+    for (auto& pin : component->getOutputPins()) {
+      pin.connectionIndex = pushConnection(pin.position);
     }
     mComponents[componentIndex] = component;
+    invalidate();
     tick();
 
-    calculateOptimalCellSize(component->getPosition());
+    extend(component->getPosition());
     return true;
   }
   void Chip::removeComponent(Point position) {
@@ -181,30 +149,10 @@ namespace Gate {
         if (!component->deletable()) {
           return;
         }
-        for (auto& pin : component->getOutputPins()) {
-          std::vector<Connection>& connections = mConnections[pin.connectionIndex];
-          std::vector<Connection> result;
-          for (auto& connection : connections) {
-            bool isComponentPin = connection.type == Connection::Type::Component && connection.componentIndex == i;
-            if (!isComponentPin) {
-              result.push_back(connection);
-            }
-          }
-          mConnections[pin.connectionIndex] = result;
-        }
-        for (auto& pin : component->getInputPins()) {
-          std::vector<Connection>& connections = mConnections[pin.connectionIndex];
-          std::vector<Connection> result;
-          for (auto& connection : connections) {
-            bool isComponentPin = connection.type == Connection::Type::Component && connection.componentIndex == i;
-            if (!isComponentPin) {
-              result.push_back(connection);
-            }
-          }
-          mConnections[pin.connectionIndex] = result;
-        }
         delete component;
         mComponents[i] = nullptr;
+        compactConnections();
+        invalidate();
         tick();
         break;
       }
@@ -250,24 +198,14 @@ namespace Gate {
       mWires[freeSlot] = wire;
     }
 
-    mWires[freeSlot].free = true;
-
-    auto connectionResultFrom = pushWireConnection(mWires[freeSlot].from, freeSlot);
-    if (!connectionResultFrom.successful) {
-      return WirePushState::Invalid;
-    }
-    auto connectionResultTo = pushWireConnection(mWires[freeSlot].to, freeSlot);
-    if (!connectionResultTo.successful) {
-      return WirePushState::Invalid;
-    }
-    mWires[freeSlot].connectionIndexes.push_back(connectionResultFrom.connectionIndex);
-    mWires[freeSlot].connectionIndexes.push_back(connectionResultTo.connectionIndex);
-
+    mWires[freeSlot].connectionIndexes.push_back(pushConnection(mWires[freeSlot].from));
+    mWires[freeSlot].connectionIndexes.push_back(pushConnection(mWires[freeSlot].to));
     mWires[freeSlot].free = false;
 
+    invalidate();
     tick();
-    calculateOptimalCellSize(mWires[freeSlot].from);
-    calculateOptimalCellSize(mWires[freeSlot].to);
+    extend(mWires[freeSlot].from);
+    extend(mWires[freeSlot].to);
     return connected ? WirePushState::Connected : WirePushState::Valid;
   }
   void Chip::removeWire(Point position) {
@@ -293,173 +231,1061 @@ namespace Gate {
       } else {
         GATE_UNREACHABLE("There should only be horizontal or veritcal lines!");
       }
-      
-      // If wire has been freed, delete connections
-      if (wire.free) {
-        for (auto& connectionIndex : wire.connectionIndexes) {
-          auto& connections = mConnections[connectionIndex];
-          std::vector<Connection> result;
-          for (auto& connection : connections) {
-            if (connection.type == Connection::Type::Wire && connection.index == i) {
-              continue;
-            }
-            result.push_back(connection);
-          }
-          mConnections[connectionIndex] = result;
-        }
-      }
     }
 
     if (hasRemoved) {
+      compactConnections();
+      invalidate();
       tick();
     }
   }
 
-  void Chip::tick() {
-    enum class Type {
-      Component,
-      Wire,
-    };
-    struct Node {
-      Type type;
-      u32 index;
-      bool activate;
-      Component* component = nullptr;
-
-      bool visitedOnce = false;
+  void Chip::invalidate() {
+    mCompiled = false;
+    mRevision++;
+  }
 
-      bool operator<(const Node &rhs) const {
-        return (u32)this->visitedOnce > (u32)rhs.visitedOnce;
+  bool Chip::isCompiled() const {
+    if (!mCompiled) {
+      return false;
+    }
+    // Inlined sub-chips may have been edited since.
+    for (auto&[chip, revision] : mDependencies) {
+      if (chip->mRevision != revision) {
+        return false;
       }
-    };
+    }
+    return true;
+  }
 
-    std::priority_queue<Node, std::vector<Node>> queue;
-    auto enqueueComponent = [&](u32 index, bool activate) {
-      if (mComponents[index]->isVisited()) {
-        return;
-      }
-      queue.push(
-        Node {
-          Type::Component,
-          index,
-          activate,
-          mComponents[index]
-        }
-      );
-    };
-    auto enqueueWire = [&](u32 index, bool activate) {
-      if (mWires[index].free) {
-        GATE_UNREACHABLE("We shouldn't enque a freed wire!");
-      }
-      if (mWires[index].visited) {
-        return;
-      }
-      queue.push(
-        Node {
-          Type::Wire,
-          index,
-          activate,
-        }
-      );
-    };
-    auto enqueueConnections = [&](std::vector<Connection>& connections, bool activate) {
-      for (auto& connection : connections) {
-        switch (connection.type) {
-          case Connection::Type::Component: {
-            enqueueComponent(connection.componentIndex, activate);
-          } break;
-          case Connection::Type::Wire: {
-            enqueueWire(connection.index, activate);
-          } break;
-        }
+  u32 Chip::groupConnections(std::vector<u32>& groups) const {
+    // Connection points that are joined by wires form a single net, the wires are
+    // merged with union-find (union by lowest index, with path halving).
+    groups.resize(mConnectionPointCount);
+    for (u32 i = 0; i < mConnectionPointCount; ++i) {
+      groups[i] = i;
+    }
+    auto find = [&groups](u32 i) {
+      while (groups[i] != i) {
+        groups[i] = groups[groups[i]];
+        i = groups[i];
       }
+      return i;
     };
+    for (auto& wire : mWires) {
+      if (wire.free) {
+        continue;
+      }
+      u32 a = find(wire.connectionIndexes[0]);
+      u32 b = find(wire.connectionIndexes[1]);
+      if (a != b) {
+        groups[std::max(a, b)] = std::min(a, b);
+      }
+    }
 
-    // Clear visited flags on components and wires
-    for (usize i = 0; i < mComponents.size(); ++i) {
-      auto* component = mComponents[i];
+    // Roots always have a lower index than their children, so a single pass numbers the groups.
+    u32 groupCount = 0;
+    for (u32 i = 0; i < mConnectionPointCount; ++i) {
+      groups[i] = groups[i] == i ? groupCount++ : groups[groups[i]];
+    }
+    return groupCount;
+  }
+
+  void Chip::emit(Emitter& emitter, const std::vector<Simulation::NetId>* inputs, std::vector<Simulation::NetId>& outputs) const {
+    using namespace Simulation;
+
+    auto& builder = emitter.builder;
+
+    std::vector<u32> groups;
+    u32 groupCount = groupConnections(groups);
+
+    // Every output pin drives its own nets, nets with multiple drivers are wired-or'ed bit by bit.
+    // A group is as wide as its widest pin, the bits of a bus are consecutive nets and narrower
+    // pins are connected to the low bits. The switches of an inlined chip are driven by the nets
+    // of its instance.
+    std::vector<u32> driverCounts(groupCount, 0);
+    std::vector<u32> widths(groupCount, 1);
+    for (auto* component : mComponents) {
       if (!component) {
         continue;
       }
-      component->resetVisited();
-      if (component->getCategory() == Component::Category::Input) {
-        enqueueComponent((u32)i, true);
+      for (auto& pin : component->getInputPins()) {
+        widths[groups[pin.connectionIndex]] = std::max(widths[groups[pin.connectionIndex]], pin.width);
+      }
+      for (auto& pin : component->getOutputPins()) {
+        driverCounts[groups[pin.connectionIndex]]++;
+        widths[groups[pin.connectionIndex]] = std::max(widths[groups[pin.connectionIndex]], pin.width);
       }
     }
-    for (auto& wire : mWires) {
-      if (wire.free) {
+    std::vector<NetId> nets(groupCount, NULL_NET);
+    std::vector<NetId> drivers;
+    std::unordered_map<u32, std::vector<std::pair<NetId, u32>>> merges;
+    u32 inputIndex = 0;
+    for (auto* component : mComponents) {
+      if (!component) {
         continue;
       }
-      wire.visited = false;
-      wire.active = false;
+      for (auto& pin : component->getOutputPins()) {
+        u32 group = groups[pin.connectionIndex];
+        NetId net;
+        if (component->getType() == Component::Type::Switch && inputs) {
+          net = inputIndex < inputs->size() ? (*inputs)[inputIndex] : builder.addNet();
+          inputIndex++;
+        } else {
+          net = builder.addNets(pin.width);
+        }
+        drivers.push_back(net);
+        if (driverCounts[group] == 1 && pin.width == widths[group]) {
+          nets[group] = net;
+        } else {
+          merges[group].emplace_back(net, pin.width);
+        }
+      }
+    }
+    for (u32 group = 0; group < groupCount; ++group) {
+      if (nets[group] == NULL_NET) {
+        nets[group] = builder.addNets(widths[group]);
+      }
     }
+    // Delays only matter for the timing simulation.
+    auto setWireDelay = [&] {
+      if (emitter.delays) {
+        builder.setDelay(emitter.delays->wire);
+      }
+    };
 
-    for (; !queue.empty(); queue.pop()) {
-      auto node = queue.top();
-      auto&[type, index, activate, component, visitedOnce] = node;
-      switch (type) {
-        case Type::Component: {
-          component->setVisited(true);
-          auto& pins = component->getInputPins();
-          for (u32 pinIndex = 0; pinIndex < pins.size(); ++pinIndex) {
-            auto& pin = pins[pinIndex];
-            if (pin.visited) {
-              continue;
-            }
+    setWireDelay();
+    // The bits above the widest driver have an empty merge, they are 0.
+    for (auto&[group, groupDrivers] : merges) {
+      for (u32 bit = 0; bit < widths[group]; ++bit) {
+        std::vector<NetId> bitDrivers;
+        for (auto&[net, width] : groupDrivers) {
+          if (bit < width) {
+            bitDrivers.push_back(net + bit);
+          }
+        }
+        builder.addMerge(std::move(bitDrivers), nets[group] + bit);
+      }
+    }
 
-            auto& connections = mConnections[pin.connectionIndex];
-            ConnectionState state;
-            for (auto& connection : connections) {    
-              // Exclude the current pin
-              if (
-                connection.type == Connection::Type::Component
-                && mComponents[connection.componentIndex] == component
-                && connection.index == pinIndex
-              ) {
-                continue;
-              }
-
-              auto newState = getConnectionState(connection);
-              if (newState.visited) {
-                state.visited = true;
-                state.active  = state.active || newState.active;
-              }
+    u32 driverIndex = 0;
+    for (auto* component : mComponents) {
+      if (!component) {
+        continue;
+      }
+      auto& inputPins = component->getInputPins();
+      auto& outputPins = component->getOutputPins();
+      auto input  = [&](u32 index, u32 bit = 0) { return nets[groups[inputPins[index].connectionIndex]] + bit; };
+      auto output = [&](u32 index, u32 bit = 0) { return drivers[driverIndex + index] + bit; };
+      if (emitter.delays) {
+        builder.setDelay(emitter.delays->get(component->getType()));
+      }
+      switch (component->getType()) {
+        case Component::Type::Switch:
+          if (!inputs) {
+            builder.addInput(output(SwitchComponent::OUTPUT_INDEX));
+          }
+          break;
+        case Component::Type::Clock:
+          emitter.clocks.emplace_back(output(ClockComponent::OUTPUT_INDEX), ((ClockComponent*)component)->getPeriod());
+          break;
+        case Component::Type::Output:
+          if (!inputs) {
+            builder.addOutput(input(OutputComponent::INPUT_INDEX));
+          }
+          outputs.push_back(input(OutputComponent::INPUT_INDEX));
+          break;
+        case Component::Type::AndGate:
+          builder.addGate(Opcode::And, input(AndComponent::A_INPUT_INDEX), input(AndComponent::B_INPUT_INDEX), output(AndComponent::OUTPUT_INDEX));
+          break;
+        case Component::Type::OrGate:
+          builder.addGate(Opcode::Or, input(OrComponent::A_INPUT_INDEX), input(OrComponent::B_INPUT_INDEX), output(OrComponent::OUTPUT_INDEX));
+          break;
+        case Component::Type::XorGate:
+          builder.addGate(Opcode::Xor, input(XorComponent::A_INPUT_INDEX), input(XorComponent::B_INPUT_INDEX), output(XorComponent::OUTPUT_INDEX));
+          break;
+        case Component::Type::NotGate:
+          builder.addGate(Opcode::Not, input(NotComponent::INPUT_INDEX), output(NotComponent::OUTPUT_INDEX));
+          break;
+        case Component::Type::FlipFlop:
+          builder.addRegister(input(DFlipFlopComponent::D_INPUT_INDEX), input(DFlipFlopComponent::CLOCK_INPUT_INDEX), output(DFlipFlopComponent::OUTPUT_INDEX));
+          break;
+        case Component::Type::Register: {
+          auto* reg = (RegisterComponent*)component;
+          for (u32 i = 0; i < reg->getWidth(); ++i) {
+            builder.addRegister(input(i), input(reg->getClockInputIndex()), output(i));
+          }
+        } break;
+        case Component::Type::Ram: {
+          auto* ram = (RamComponent*)component;
+          Memory memory;
+          memory.dataWidth = ram->getDataWidth();
+          for (u32 i = 0; i < ram->getAddressWidth(); ++i) {
+            memory.address.push_back(input(i));
+          }
+          for (u32 i = 0; i < ram->getDataWidth(); ++i) {
+            memory.data.push_back(input(ram->getDataInputIndex(i)));
+          }
+          memory.write = input(ram->getWriteInputIndex());
+          memory.clock = input(ram->getClockInputIndex());
+          std::vector<NetId> memoryOutputs;
+          for (u32 i = 0; i < outputPins.size(); ++i) {
+            memoryOutputs.push_back(output(i));
+          }
+          builder.addMemory(std::move(memory), std::move(memoryOutputs));
+        } break;
+        case Component::Type::Rom: {
+          auto* rom = (RomComponent*)component;
+          Memory memory;
+          memory.dataWidth = rom->getDataWidth();
+          for (u32 i = 0; i < rom->getAddressWidth(); ++i) {
+            memory.address.push_back(input(i));
+          }
+          memory.contents = rom->getContents();
+          std::vector<NetId> memoryOutputs;
+          for (u32 i = 0; i < outputPins.size(); ++i) {
+            memoryOutputs.push_back(output(i));
+          }
+          builder.addMemory(std::move(memory), std::move(memoryOutputs));
+        } break;
+        case Component::Type::Splitter:
+          for (u32 i = 0; i < outputPins.size(); ++i) {
+            builder.addGate(Opcode::Buffer, input(SplitterComponent::INPUT_INDEX, i), output(i));
+          }
+          break;
+        case Component::Type::Merger:
+          for (u32 i = 0; i < inputPins.size(); ++i) {
+            builder.addGate(Opcode::Buffer, input(i), output(MergerComponent::OUTPUT_INDEX, i));
+          }
+          break;
+        case Component::Type::WordAnd:
+        case Component::Type::WordOr:
+        case Component::Type::WordXor: {
+          // The bits are independent gates, usually of the same level, so they end up in one group.
+          const auto type = component->getType();
+          const Opcode opcode = type == Component::Type::WordAnd ? Opcode::And : type == Component::Type::WordOr ? Opcode::Or : Opcode::Xor;
+          for (u32 i = 0; i < ((WordComponent*)component)->getWidth(); ++i) {
+            builder.addGate(opcode, input(WordComponent::A_INPUT_INDEX, i), input(WordComponent::B_INPUT_INDEX, i), output(WordComponent::OUTPUT_INDEX, i));
+          }
+        } break;
+        case Component::Type::WordAdd: {
+          // Ripple carry: sum = a ^ b ^ carry, carry = (a & b) | ((a ^ b) & carry).
+          auto setDelay = [&](u32 Delays::* delay) {
+            if (emitter.delays) {
+              builder.setDelay(emitter.delays->*delay);
             }
-            if (!(visitedOnce || state.visited)) {
-              node.visitedOnce = true;
-              component->setVisited(false);
-              queue.push(node);
+          };
+          NetId carry = NULL_NET;
+          for (u32 i = 0; i < ((WordComponent*)component)->getWidth(); ++i) {
+            const NetId a = input(WordComponent::A_INPUT_INDEX, i);
+            const NetId b = input(WordComponent::B_INPUT_INDEX, i);
+            const NetId sum = output(WordComponent::OUTPUT_INDEX, i);
+            const NetId half = carry == NULL_NET ? sum : builder.addNet();
+            const NetId generate = builder.addNet();
+            setDelay(&Delays::xorGate);
+            builder.addGate(Opcode::Xor, a, b, half);
+            setDelay(&Delays::andGate);
+            builder.addGate(Opcode::And, a, b, generate);
+            if (carry == NULL_NET) {
+              carry = generate;
               continue;
             }
-            pin.visited = state.visited;
-            pin.active = state.active;
+            const NetId propagate = builder.addNet();
+            const NetId next = builder.addNet();
+            setDelay(&Delays::xorGate);
+            builder.addGate(Opcode::Xor, half, carry, sum);
+            setDelay(&Delays::andGate);
+            builder.addGate(Opcode::And, half, carry, propagate);
+            setDelay(&Delays::orGate);
+            builder.addGate(Opcode::Or, generate, propagate, next);
+            carry = next;
+          }
+          setWireDelay();
+          builder.addGate(Opcode::Buffer, carry, output(WordComponent::CARRY_INDEX));
+        } break;
+        case Component::Type::Chip: {
+          // Sub-chips are inlined, so every instance has its own nets.
+          auto* chip = ((ChipComponent*)component)->getChip().get();
+          if (std::find(emitter.path.begin(), emitter.path.end(), chip) != emitter.path.end()) {
+            Logger::error("Chip: '%s' contains itself, its instance is left unconnected", chip->getName().c_str());
+            break;
+          }
+          std::vector<NetId> chipInputs;
+          std::vector<NetId> chipOutputs;
+          for (u32 i = 0; i < inputPins.size(); ++i) {
+            chipInputs.push_back(input(i));
           }
 
-          if (component->areAllInputPinsVisited()) {
-            component->update();
-            for (auto& pin : component->getOutputPins()) {
-              pin.visited = true;
-              auto& connections = mConnections[pin.connectionIndex];
-              enqueueConnections(connections, pin.active);
+          auto table = chip->isMemoized() ? chip->getTruthTable() : nullptr;
+          if (table && table->inputCount == inputPins.size() && table->outputCount == outputPins.size()) {
+            for (u32 i = 0; i < outputPins.size(); ++i) {
+              chipOutputs.push_back(output(i));
             }
+            builder.addLookup(std::move(table), std::move(chipInputs), std::move(chipOutputs));
+            emitter.dependencies.emplace_back(chip, chip->mRevision);
+            emitter.dependencies.insert(emitter.dependencies.end(), chip->mDependencies.begin(), chip->mDependencies.end());
+            break;
+          }
+
+          emitter.path.push_back(chip);
+          emitter.dependencies.emplace_back(chip, chip->mRevision);
+          chip->emit(emitter, &chipInputs, chipOutputs);
+          emitter.path.pop_back();
+          setWireDelay();
+          for (u32 i = 0; i < outputPins.size() && i < chipOutputs.size(); ++i) {
+            builder.addGate(Opcode::Buffer, chipOutputs[i], output(i));
           }
         } break;
-        case Type::Wire: {
-          auto& wire = mWires[index];
-          if (wire.free) {
-            GATE_UNREACHABLE("We shouldn't access a freed wire!");
+      }
+      driverIndex += (u32)outputPins.size();
+    }
+
+    if (!inputs) {
+      for (auto&[net, period] : emitter.clocks) {
+        builder.addInput(net);
+      }
+      emitter.connectionNets.resize(mConnectionPointCount);
+      emitter.connectionWidths.resize(mConnectionPointCount);
+      for (u32 i = 0; i < mConnectionPointCount; ++i) {
+        emitter.connectionNets[i] = nets[groups[i]];
+        emitter.connectionWidths[i] = widths[groups[i]];
+      }
+      emitter.drivers = std::move(drivers);
+    }
+  }
+
+  void Chip::compile() {
+    using namespace Simulation;
+
+    Emitter emitter{Netlist::builder(), {this}, {}, {}, {}, {}, nullptr, {}};
+    std::vector<NetId> outputs;
+    emit(emitter, nullptr, outputs);
+
+    mInputComponents.clear();
+    mComponentInputIndexes.assign(mComponents.size(), UINT32_MAX);
+    u32 driverIndex = 0;
+    for (u32 i = 0; i < mComponents.size(); ++i) {
+      auto* component = mComponents[i];
+      if (!component) {
+        continue;
+      }
+      for (auto& pin : component->getInputPins()) {
+        pin.net = emitter.connectionNets[pin.connectionIndex];
+      }
+      for (auto& pin : component->getOutputPins()) {
+        pin.net = emitter.drivers[driverIndex++];
+      }
+      if (component->getType() == Component::Type::Switch) {
+        mComponentInputIndexes[i] = (u32)mInputComponents.size();
+        mInputComponents.push_back(i);
+      }
+    }
+    std::vector<u32> periods;
+    for (auto&[net, period] : emitter.clocks) {
+      periods.push_back(period);
+    }
+    mClock.setClocks((u32)mInputComponents.size(), std::move(periods));
+
+    // Wires don't take part in the simulation, they only display the value of their net.
+    for (auto& wire : mWires) {
+      if (!wire.free) {
+        wire.net = emitter.connectionNets[wire.connectionIndexes[0]];
+        wire.width = emitter.connectionWidths[wire.connectionIndexes[0]];
+      }
+    }
+    mDependencies = std::move(emitter.dependencies);
+
+    // Only the nets that are displayed have to keep their values, the rest can be optimized away.
+    std::vector<NetId> observed;
+    for (auto* component : mComponents) {
+      if (!component) {
+        continue;
+      }
+      for (auto& pin : component->getInputPins()) {
+        for (u32 bit = 0; bit < pin.width; ++bit) {
+          observed.push_back(pin.net + bit);
+        }
+      }
+      for (auto& pin : component->getOutputPins()) {
+        for (u32 bit = 0; bit < pin.width; ++bit) {
+          observed.push_back(pin.net + bit);
+        }
+      }
+    }
+    for (auto& wire : mWires) {
+      if (!wire.free) {
+        for (u32 bit = 0; bit < wire.width; ++bit) {
+          observed.push_back(wire.net + bit);
+        }
+      }
+    }
+    mNetlist = Optimizer::optimize(emitter.builder.build(), observed);
+    mEngine.load(mNetlist);
+    mFingerprint = NativeModule::fingerprint(mNetlist);
+    mGeneration++;
+    mBatchCompiled = false;
+    mTruthTable = nullptr;
+    mOscillatingNets.assign(mNetlist.getNetCount(), false);
+    mOscillatingCount = 0;
+
+    // Every net knows which pins have to be updated when it changes, a bus pin observes all its bits.
+    const u32 netCount = mNetlist.getNetCount();
+    mObserverOffsets.assign(netCount + 1, 0);
+    for (auto* component : mComponents) {
+      if (!component) {
+        continue;
+      }
+      for (auto& pin : component->getInputPins()) {
+        for (u32 bit = 0; bit < pin.width; ++bit) {
+          mObserverOffsets[pin.net + bit + 1]++;
+        }
+      }
+      for (auto& pin : component->getOutputPins()) {
+        for (u32 bit = 0; bit < pin.width; ++bit) {
+          mObserverOffsets[pin.net + bit + 1]++;
+        }
+      }
+    }
+    for (u32 net = 0; net < netCount; ++net) {
+      mObserverOffsets[net + 1] += mObserverOffsets[net];
+    }
+    mObservers.resize(mObserverOffsets[netCount]);
+    std::vector<u32> cursor(mObserverOffsets.begin(), mObserverOffsets.end() - 1);
+    for (auto* component : mComponents) {
+      if (!component) {
+        continue;
+      }
+      for (auto& pin : component->getInputPins()) {
+        for (u32 bit = 0; bit < pin.width; ++bit) {
+          mObservers[cursor[pin.net + bit]++] = &pin;
+        }
+      }
+      for (auto& pin : component->getOutputPins()) {
+        for (u32 bit = 0; bit < pin.width; ++bit) {
+          mObservers[cursor[pin.net + bit]++] = &pin;
+        }
+      }
+    }
+
+    mCompiled = true;
+    if (mTiming) {
+      compileTiming();
+    }
+    if (mRecording) {
+      updateRecordedNets();
+    }
+  }
+
+  void Chip::compileTiming() {
+    using namespace Simulation;
+
+    // The same emission as compile(), so the nets are the same, but without optimizations.
+    Emitter emitter{Netlist::builder(), {this}, {}, {}, {}, {}, &mDelays, {}};
+    std::vector<NetId> outputs;
+    emit(emitter, nullptr, outputs);
+    mTimingNetlist = emitter.builder.build();
+    mTimingEngine.load(mTimingNetlist);
+
+    for (u32 i = 0; i < mInputComponents.size(); ++i) {
+      auto* component = mComponents[mInputComponents[i]];
+      mTimingEngine.setInput(i, component->getOutputPins()[SwitchComponent::OUTPUT_INDEX].active);
+    }
+    // The clocks don't run in timing mode.
+    for (u32 i = 0; i < mClock.getClockCount(); ++i) {
+      mTimingEngine.setInput(mClock.getFirstInput() + i, mClock.getValue(i, mClock.getHalfCycle()));
+    }
+    for (u32 net = 0; net < mTimingNetlist.getNetCount(); ++net) {
+      writeBackTiming(net);
+    }
+  }
+
+  void Chip::compileBatch() {
+    using namespace Simulation;
+
+    // The same emission as compile(), so the nets are the same, but only the outputs are observed.
+    Emitter emitter{Netlist::builder(), {this}, {}, {}, {}, {}, nullptr, {}};
+    std::vector<NetId> outputs;
+    emit(emitter, nullptr, outputs);
+    mBatchNetlist = Optimizer::optimize(emitter.builder.build(), {});
+    mBatchEngine.load(mBatchNetlist);
+
+    for (u32 i = 0; i < mInputComponents.size(); ++i) {
+      auto* component = mComponents[mInputComponents[i]];
+      mBatchEngine.setInput(i, component->getOutputPins()[SwitchComponent::OUTPUT_INDEX].active);
+    }
+    mClock.apply(mBatchEngine);
+    mBatchEngine.evaluate();
+    mBatchCompiled = true;
+  }
+
+  void Chip::prepareBatch() {
+    if (!isCompiled()) {
+      tick();
+    }
+    if (!mBatchCompiled) {
+      compileBatch();
+    }
+  }
+
+  void Chip::updateOscillations(bool writeBackChanges) {
+    auto& loops = mNetlist.getLoops();
+    auto& instructions = mNetlist.getInstructions();
+    for (u32 loop = 0; loop < loops.size(); ++loop) {
+      const bool oscillating = mEngine.isOscillating(loop);
+      for (u32 i = loops[loop].begin; i < loops[loop].end; ++i) {
+        auto net = instructions[i].output;
+        if (mOscillatingNets[net] != oscillating) {
+          mOscillatingNets[net] = oscillating;
+          if (writeBackChanges) {
+            writeBack(net);
           }
-          wire.visited = true;
-          wire.active = activate;
-          for (auto& connectionIndex : wire.connectionIndexes) {
-            auto& connection = mConnections[connectionIndex];
-            enqueueConnections(connection, wire.active);
+        }
+      }
+    }
+
+    // Only report changes, the chip is evaluated every frame.
+    const u32 count = mEngine.getOscillatingCount();
+    if (count != mOscillatingCount && count != 0) {
+      Logger::warn("Chip: '%s' has %u oscillating feedback loop(s)", mName.c_str(), count);
+    }
+    mOscillatingCount = count;
+  }
+
+  void Chip::writeBack(Simulation::NetId net) {
+    bool visited = mNetlist.isValid(net) && !mOscillatingNets[net];
+    bool active  = mEngine.getValue(net);
+    for (u32 i = mObserverOffsets[net]; i < mObserverOffsets[net + 1]; ++i) {
+      auto* pin = mObservers[i];
+      if (pin->width > 1) {
+        pin->visited = true;
+        pin->active  = false;
+        for (Simulation::NetId bit = pin->net; bit < pin->net + pin->width; ++bit) {
+          pin->visited = pin->visited && mNetlist.isValid(bit) && !mOscillatingNets[bit];
+          pin->active  = pin->active || mEngine.getValue(bit);
+        }
+        continue;
+      }
+      pin->visited = visited;
+      pin->active  = active;
+    }
+  }
+
+  void Chip::writeBackTiming(Simulation::NetId net) {
+    bool visited = mTimingNetlist.isValid(net);
+    bool active  = mTimingEngine.getValue(net);
+    for (u32 i = mObserverOffsets[net]; i < mObserverOffsets[net + 1]; ++i) {
+      auto* pin = mObservers[i];
+      if (pin->width > 1) {
+        pin->visited = true;
+        pin->active  = false;
+        for (Simulation::NetId bit = pin->net; bit < pin->net + pin->width; ++bit) {
+          pin->visited = pin->visited && mTimingNetlist.isValid(bit);
+          pin->active  = pin->active || mTimingEngine.getValue(bit);
+        }
+        continue;
+      }
+      pin->visited = visited;
+      pin->active  = active;
+    }
+  }
+
+  bool Chip::isActive(Simulation::NetId net, u32 width) const {
+    for (u32 i = 0; i < width; ++i) {
+      const Simulation::NetId bit = net + i;
+      if (mTiming) {
+        if (bit < mTimingNetlist.getNetCount() && mTimingEngine.getValue(bit)) {
+          return true;
+        }
+      } else if (bit < mNetlist.getNetCount() && mEngine.getValue(bit)) {
+        return true;
+      }
+    }
+    return false;
+  }
+  bool Chip::isValid(Simulation::NetId net, u32 width) const {
+    for (u32 i = 0; i < width; ++i) {
+      const Simulation::NetId bit = net + i;
+      if (mTiming) {
+        if (bit >= mTimingNetlist.getNetCount() || !mTimingNetlist.isValid(bit)) {
+          return false;
+        }
+      } else if (bit >= mNetlist.getNetCount() || !mNetlist.isValid(bit) || mOscillatingNets[bit]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void Chip::propagate(u32 componentIndex) {
+    if (mTiming || !isCompiled() || mComponentInputIndexes[componentIndex] == UINT32_MAX) {
+      tick();
+      return;
+    }
+
+    auto* component = mComponents[componentIndex];
+    if (mBackground) {
+      mBackground->setInput(mComponentInputIndexes[componentIndex], component->getOutputPins()[SwitchComponent::OUTPUT_INDEX].active);
+      mSentCommandCount++;
+      return;
+    }
+    mEngine.propagate(mComponentInputIndexes[componentIndex], component->getOutputPins()[SwitchComponent::OUTPUT_INDEX].active);
+    for (auto net : mEngine.getChangedNets()) {
+      writeBack(net);
+    }
+    updateOscillations(true);
+    record(1);
+  }
+
+  void Chip::tick() {
+    if (!isCompiled()) {
+      compile();
+    }
+
+    // The changes are applied at the current time, they show up as the simulation advances.
+    if (mTiming) {
+      for (u32 i = 0; i < mInputComponents.size(); ++i) {
+        auto* component = mComponents[mInputComponents[i]];
+        mTimingEngine.setInput(i, component->getOutputPins()[SwitchComponent::OUTPUT_INDEX].active);
+      }
+      return;
+    }
+
+    if (mBackground) {
+      loadBackground({});
+      mSyncAllNets = true;
+      return;
+    }
+
+    for (u32 i = 0; i < mInputComponents.size(); ++i) {
+      auto* component = mComponents[mInputComponents[i]];
+      mEngine.setInput(i, component->getOutputPins()[SwitchComponent::OUTPUT_INDEX].active);
+    }
+    mClock.apply(mEngine);
+
+    mEngine.evaluate();
+    updateOscillations(false);
+
+    for (u32 net = 0; net < mNetlist.getNetCount(); ++net) {
+      writeBack(net);
+    }
+    record(1);
+  }
+
+  std::vector<u64> Chip::simulateVectors(Slice<const u64> inputWords) {
+    prepareBatch();
+    return mBatchEngine.simulate(inputWords);
+  }
+
+  Simulation::FaultSimulator::Report Chip::simulateFaults(Slice<const u64> inputWords, usize vectorCount, std::vector<String>* pinNames) {
+    using namespace Simulation;
+    if (!isCompiled()) {
+      tick();
+    }
+
+    // The same emission as compile(), so the pins have the same nets, but without optimizations.
+    Emitter emitter{Netlist::builder(), {this}, {}, {}, {}, {}, nullptr, {}};
+    std::vector<NetId> outputs;
+    emit(emitter, nullptr, outputs);
+    Netlist netlist = emitter.builder.build();
+
+    // Both faults of every bit of every pin, the pins that share a net share its faults.
+    std::vector<bool> visited(netlist.getNetCount(), false);
+    std::vector<FaultSimulator::Fault> faults;
+    auto addPin = [&](const Pin& pin, const char* direction) {
+      for (u32 bit = 0; bit < pin.width; ++bit) {
+        const NetId net = pin.net + bit;
+        if (visited[net]) {
+          continue;
+        }
+        visited[net] = true;
+        faults.push_back(FaultSimulator::Fault{net, false});
+        faults.push_back(FaultSimulator::Fault{net, true});
+        if (pinNames) {
+          String name = String(direction) + "(" + std::to_string(pin.position.x) + "," + std::to_string(pin.position.y) + ")";
+          if (pin.width > 1) {
+            name += "[" + std::to_string(bit) + "]";
           }
-        } break;
-      } 
+          pinNames->push_back(name);
+          pinNames->push_back(std::move(name));
+        }
+      }
+    };
+    if (pinNames) {
+      pinNames->clear();
+    }
+    for (auto* component : mComponents) {
+      if (!component) {
+        continue;
+      }
+      for (auto& pin : component->getOutputPins()) {
+        addPin(pin, "out");
+      }
+      for (auto& pin : component->getInputPins()) {
+        addPin(pin, "in");
+      }
+    }
+    return FaultSimulator::simulate(netlist, std::move(faults), inputWords, vectorCount);
+  }
+
+  Simulation::StimulusGenerator::Report Chip::runStimulus(const Simulation::StimulusGenerator::Options& options) {
+    prepareBatch();
+    return Simulation::StimulusGenerator::run(mBatchNetlist, options);
+  }
+
+  Simulation::EquivalenceChecker::Report Chip::checkEquivalence(Chip& other, const Simulation::EquivalenceChecker::Options& options) {
+    prepareBatch();
+    other.prepareBatch();
+    return Simulation::EquivalenceChecker::check(mBatchNetlist, other.mBatchNetlist, options);
+  }
+
+  void Chip::startTiming(const Delays& delays) {
+    mDelays = delays;
+    mTiming = true;
+    if (!isCompiled()) {
+      compile();
+    } else {
+      compileTiming();
+    }
+  }
+
+  void Chip::stopTiming() {
+    mTiming = false;
+    mTimingNetlist = Simulation::Netlist();
+    tick();
+  }
+
+  void Chip::advanceTiming(Simulation::Time duration) {
+    if (!mTiming) {
+      return;
+    }
+    if (!isCompiled()) {
+      tick();
+    }
+    mTimingEngine.advance(duration);
+    for (auto net : mTimingEngine.getChangedNets()) {
+      writeBackTiming(net);
+    }
+    record(duration);
+  }
+
+  Chip::State Chip::snapshot() {
+    if (!isCompiled()) {
+      tick();
+    }
+    State state;
+    state.fingerprint = mFingerprint;
+    state.halfCycle = mClock.getHalfCycle();
+    state.words.resize(mEngine.getStateWordCount());
+    mEngine.saveState(state.words.data());
+    return state;
+  }
+
+  bool Chip::restore(const State& state) {
+    if (!isCompiled()) {
+      tick();
+    }
+    if (state.fingerprint != mFingerprint || state.words.size() != mEngine.getStateWordCount()) {
+      Logger::warn("Chip: the state was taken from a different version of '%s'", mName.c_str());
+      return false;
+    }
+
+    // The switches are observers of the input nets, so they are restored too.
+    mEngine.restoreState(state.words.data());
+    mClock.setHalfCycle(state.halfCycle);
+    updateOscillations(false);
+    for (u32 net = 0; net < mNetlist.getNetCount(); ++net) {
+      writeBack(net);
+    }
+    if (mTiming) {
+      compileTiming();
+    }
+    if (mBackground) {
+      loadBackground(state.words);
+    }
+    return true;
+  }
+
+  void Chip::startBackground() {
+    if (mBackground) {
+      return;
+    }
+    mBackground = std::make_shared<Simulation::BackgroundEngine>();
+    mSentCommandCount = 0;
+    mBackgroundClockFrequency = 0.0;
+    if (!isCompiled()) {
+      tick();
+    } else {
+      std::vector<u64> state(mEngine.getStateWordCount());
+      mEngine.saveState(state.data());
+      loadBackground(std::move(state));
+    }
+    if (mClock.isRunning()) {
+      mBackground->run(mClock.getTargetFrequency());
+      mSentCommandCount++;
+    }
+  }
+
+  void Chip::stopBackground() {
+    if (!mBackground) {
+      return;
+    }
+    // The last frame is kept, the commands that weren't applied yet are dropped and the chip is evaluated again.
+    sync();
+    mBackground = nullptr;
+    tick();
+    if (mClock.isRunning()) {
+      mClock.start(mClock.getTargetFrequency());
+    }
+  }
+
+  bool Chip::sync() {
+    if (!mBackground || mTiming || !isCompiled()) {
+      return false;
+    }
+    auto* frame = mBackground->acquire();
+    if (!frame || frame->generation != mGeneration || frame->commandCount < mSentCommandCount || frame->state.size() != mEngine.getStateWordCount()) {
+      return false;
+    }
+    // The half cycles the clocks ran on the simulation thread are only seen as a whole.
+    const u64 halfCycles = frame->halfCycle > mClock.getHalfCycle() ? frame->halfCycle - mClock.getHalfCycle() : 1;
+    mEngine.restoreState(frame->state.data());
+    mClock.setHalfCycle(frame->halfCycle);
+    mBackgroundClockFrequency = frame->frequency;
+
+    // The pins already show the last frame, only the nets that changed since are written back.
+    if (mSyncAllNets) {
+      updateOscillations(false);
+      for (u32 net = 0; net < mNetlist.getNetCount(); ++net) {
+        writeBack(net);
+      }
+      mSyncAllNets = false;
+    } else {
+      updateOscillations(true);
+      for (auto net : mEngine.getChangedNets()) {
+        writeBack(net);
+      }
+    }
+    record(halfCycles);
+    return true;
+  }
+
+  void Chip::loadBackground(std::vector<u64> state) {
+    std::vector<u8> inputs;
+    for (auto index : mInputComponents) {
+      inputs.push_back(mComponents[index]->getOutputPins()[SwitchComponent::OUTPUT_INDEX].active);
+    }
+    mBackground->load(mNetlist, mGeneration, std::move(inputs), mClock, std::move(state));
+    mSentCommandCount++;
+  }
+
+  u32 Chip::getInputCount() {
+    if (!isCompiled()) {
+      tick();
+    }
+    return (u32)mNetlist.getInputs().size();
+  }
+
+  void Chip::startClocks(f64 frequency) {
+    if (!isCompiled()) {
+      tick();
+    }
+    mClock.start(frequency);
+    if (mBackground) {
+      mBackground->run(frequency);
+      mSentCommandCount++;
+    }
+  }
+
+  void Chip::stopClocks() {
+    mClock.stop();
+    if (mBackground) {
+      mBackground->stop();
+      mSentCommandCount++;
+    }
+  }
+
+  f64 Chip::getClockFrequency() const {
+    if (!mClock.isRunning()) {
+      return 0.0;
+    }
+    return mBackground ? mBackgroundClockFrequency : mClock.getFrequency();
+  }
+
+  void Chip::updateClocks(f64 budgetSeconds) {
+    if (mBackground || mTiming || !mClock.isRunning()) {
+      return;
+    }
+    if (!isCompiled()) {
+      tick();
+    }
+    if (mClock.run(mEngine, budgetSeconds) == 0) {
+      return;
+    }
+    updateOscillations(false);
+    for (u32 net = 0; net < mNetlist.getNetCount(); ++net) {
+      writeBack(net);
     }
   }
 
+  void Chip::advanceClocks(u64 cycles) {
+    if (mBackground || mTiming) {
+      return;
+    }
+    if (!isCompiled()) {
+      tick();
+    }
+    mClock.advance(mEngine, cycles * 2);
+    updateOscillations(false);
+    for (u32 net = 0; net < mNetlist.getNetCount(); ++net) {
+      writeBack(net);
+    }
+  }
+
+  void Chip::startRecording(u32 capacity) {
+    mRecording = true;
+    mRecordingCapacity = capacity;
+    mRecordTime = 0;
+    mWaveform.clear();
+    // Every half cycle of the clocks is a sample.
+    mClock.setHalfCycleHandler([this](u64) { record(1); });
+    if (!isCompiled()) {
+      tick();
+    } else {
+      updateRecordedNets();
+    }
+    record(0);
+  }
+
+  void Chip::stopRecording() {
+    mRecording = false;
+    mClock.setHalfCycleHandler(nullptr);
+  }
+
+  bool Chip::exportWaveform(const String& path) const {
+    return mWaveform.exportVcd(path, mName);
+  }
+
+  // The switches and outputs keep their names while the chip is edited, so the samples are only
+  // dropped when one is added or removed.
+  void Chip::updateRecordedNets() {
+    auto& inputs  = mNetlist.getInputs();
+    auto& outputs = mNetlist.getOutputs();
+    std::vector<String> names;
+    mRecordedNets.clear();
+    for (u32 i = 0; i < inputs.size(); ++i) {
+      names.push_back("in" + std::to_string(i));
+      mRecordedNets.push_back(inputs[i]);
+    }
+    for (u32 i = 0; i < outputs.size(); ++i) {
+      names.push_back("out" + std::to_string(i));
+      mRecordedNets.push_back(outputs[i]);
+    }
+    mWaveform.setSignals(std::move(names), mRecordingCapacity);
+  }
+
+  void Chip::record(Simulation::Time elapsed) {
+    if (!mRecording) {
+      return;
+    }
+    mRecordTime += elapsed;
+    mWaveform.record(mRecordTime, [this](u32 i) { return isActive(mRecordedNets[i]); });
+  }
+
+  void Chip::setMemoized(bool memoized) {
+    if (mMemoized != memoized) {
+      mMemoized = memoized;
+      invalidate();
+    }
+  }
+
+  void Chip::prepareInstances() {
+    if (mMemoized) {
+      getTruthTable();
+    }
+  }
+
+  Ref<const Simulation::TruthTable> Chip::getTruthTable() {
+    using namespace Simulation;
+
+    // The chip contains itself through other memoized chips, it is inlined (and the cycle reported).
+    if (mBuildingTruthTable) {
+      return nullptr;
+    }
+    if (!isCompiled() || !mBatchCompiled) {
+      mBuildingTruthTable = true;
+      if (!isCompiled()) {
+        compile();
+      }
+      if (!mBatchCompiled) {
+        compileBatch();
+      }
+      mBuildingTruthTable = false;
+    }
+    if (mTruthTable) {
+      return mTruthTable;
+    }
+
+    // Only a pure function of the inputs can be tabulated.
+    auto& inputs  = mBatchNetlist.getInputs();
+    auto& outputs = mBatchNetlist.getOutputs();
+    if (inputs.empty() || inputs.size() > TruthTable::MAX_INPUTS || !mBatchNetlist.getLoops().empty() || !mBatchNetlist.getRegisters().empty()) {
+      return nullptr;
+    }
+    for (auto& memory : mBatchNetlist.getMemories()) {
+      if (memory.isWritable()) {
+        return nullptr;
+      }
+    }
+    for (auto net : outputs) {
+      if (!mBatchNetlist.isValid(net)) {
+        return nullptr;
+      }
+    }
+
+    // Every input combination is simulated at once, vector i has the inputs of index i.
+    auto table = std::make_shared<TruthTable>();
+    table->inputCount  = (u32)inputs.size();
+    table->outputCount = (u32)outputs.size();
+    const usize wordCount = table->getWordCount();
+    std::vector<u64> inputWords(wordCount * inputs.size(), 0);
+    for (usize word = 0; word < wordCount; ++word) {
+      for (u32 i = 0; i < inputs.size(); ++i) {
+        for (u32 lane = 0; lane < 64; ++lane) {
+          inputWords[word * inputs.size() + i] |= u64(((word * 64 + lane) >> i) & 1) << lane;
+        }
+      }
+    }
+    auto outputWords = mBatchEngine.simulate(Slice<const u64>(inputWords.data(), inputWords.size()));
+    table->words.resize(wordCount * outputs.size());
+    for (usize word = 0; word < wordCount; ++word) {
+      for (u32 output = 0; output < outputs.size(); ++output) {
+        table->words[output * wordCount + word] = outputWords[word * outputs.size() + output];
+      }
+    }
+    mTruthTable = std::move(table);
+    return mTruthTable;
+  }
+
+  bool Chip::exportNative(const String& path) {
+    prepareBatch();
+    String source;
+    if (!Simulation::NativeModule::generate(mBatchNetlist, source)) {
+      return false;
+    }
+    return Utils::stringToFile(path, source);
+  }
+
+  bool Chip::loadNative(const String& path) {
+    prepareBatch();
+    auto module = Simulation::NativeModule::load(path, mBatchNetlist);
+    if (!module) {
+      return false;
+    }
+    mBatchEngine.setNative(std::move(module));
+    mBatchEngine.evaluate();
+    return true;
+  }
+
   void Chip::render(Renderer2D& renderer) {
     renderComponentBodys(renderer);
     renderWires(renderer);
@@ -484,7 +1310,7 @@ namespace Gate {
       if (wire.free) {
         continue;
       }
-      wire.render(renderer);
+      wire.render(renderer, isActive(wire.net, wire.width), isValid(wire.net, wire.width));
     }
   }
 
@@ -516,7 +1342,7 @@ namespace Gate {
       if (wire.free) {
         continue;
       }
-      wire.render(renderer);
+      wire.render(renderer, isActive(wire.net, wire.width));
     }
   }
 
@@ -525,6 +1351,9 @@ namespace Gate {
     std::vector<OutputComponent*> outputs;
 
     for (auto component : mComponents) {
+      if (!component) {
+        continue;
+      }
       if (component->getType() == Component::Type::Switch) {
         inputs.push_back((SwitchComponent*)component);
       } if (component->getType() == Component::Type::Output) {
@@ -542,6 +1371,9 @@ namespace Gate::Serializer {
   Node Convert<Chip>::encode(Chip& chip) {
     auto node = Node::object();
     node["name"] = chip.getName();
+    if (chip.isMemoized()) {
+      node["memoize"] = true;
+    }
     auto wires = Node::array();
     for (auto& wire : chip.getWires()) {
       if (wire.free) {
@@ -560,12 +1392,17 @@ namespace Gate::Serializer {
     node["components"] = components;
     return node;
   }
-  bool Convert<Chip>::decode(const Node& node, Chip& chip, Board& board) {
+  bool Convert<Chip>::decode(const Node& node, Chip& chip, const std::vector<Chip::Handle>& chips, const String& directory) {
     if (!node.isObject()) return false;
     auto* nameNode = node.get("name");
     if (!nameNode || !nameNode->isString()) return false;
     chip.setName(*nameNode->asString());
 
+    auto* memoizeNode = node.get("memoize");
+    if (memoizeNode && memoizeNode->isBoolean()) {
+      chip.setMemoized(*memoizeNode->asBoolean());
+    }
+
     auto* wiresNode = node.get("wires");
     if (!wiresNode || !wiresNode->isArray()) return false;
     auto& wiresArray = *wiresNode->asArray();
@@ -579,7 +1416,7 @@ namespace Gate::Serializer {
     if (!componentsNode || !componentsNode->isArray()) return false;
     auto& componentsArray = *componentsNode->asArray();
     for (auto& componentNode : componentsArray) {
-      Component* component = Component::decode(componentNode, board);
+      Component* component = Component::decode(componentNode, chips, directory);
       if (!component) return false;
       chip.pushComponent(component);
     }
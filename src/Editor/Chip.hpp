@@ -4,27 +4,42 @@
 #include "Editor/Config.hpp"
 #include "Editor/Wire.hpp"
 #include "Editor/Components.hpp"
-#include "Editor/Connection.hpp"
+#include "Editor/Delays.hpp"
 #include "Renderer/Renderer2D.hpp"
 #include "Renderer/Renderer3D.hpp"
 #include "Serializer/Serializer.hpp"
+#include "Simulation/Netlist.hpp"
+#include "Simulation/Background.hpp"
+#include "Simulation/Clock.hpp"
+#include "Simulation/Engine.hpp"
+#include "Simulation/Equivalence.hpp"
+#include "Simulation/Fault.hpp"
+#include "Simulation/Stimulus.hpp"
+#include "Simulation/Timing.hpp"
+#include "Simulation/Waveform.hpp"
 
 #include <unordered_map>
 
 namespace Gate {
 
-  class Board;
-
   enum class WirePushState {
     Valid,
     Connected,
-    Invalid,
   };
 
   class Chip {
   public:
     using Handle = Ref<Chip>;
 
+    // Simulation state, without the topology (see Simulation::Engine::saveState()). A state can
+    // only be restored into the chip it was taken from, as long as its netlist hasn't changed.
+    // In timing mode the timing simulation restarts with the restored switches.
+    struct State {
+      u64 fingerprint = 0;
+      u64 halfCycle = 0;
+      std::vector<u64> words;
+    };
+
   public:
   static Chip::Handle create(u32 index);
 
@@ -40,16 +55,105 @@ namespace Gate {
     void removeComponent(Point position);
     void removeWire(Point position);
     WirePushState pushWire(Wire wire);
-    bool click(Point position);
-    bool click(u32 id);
+    // Returns false when there is no component to click. Only a switch changes the simulation
+    // state without recompiling, so previous is set to the state from before the click for a
+    // switch and left untouched otherwise.
+    bool click(Point position, State* previous = nullptr);
+    bool click(u32 id, State* previous = nullptr);
     void tick();
 
+    // Evaluates 64 input vectors per word, see Simulation::Engine::simulate().
+    std::vector<u64> simulateVectors(Slice<const u64> inputWords);
+
+    // Stuck-at fault simulation of the pins (see Simulation::FaultSimulator), on the netlist
+    // without optimizations so every pin keeps its own net. The vectors are laid out as for
+    // simulateVectors(). The name of the pin of every fault is written to pinNames, e.g.
+    // "out(5,1)", or "in(3,1)[7]" for a bit of a bus.
+    Simulation::FaultSimulator::Report simulateFaults(Slice<const u64> inputWords, usize vectorCount, std::vector<String>* pinNames = nullptr);
+
+    // Toggle coverage of generated vectors on the switches, see Simulation::StimulusGenerator.
+    // The pins are left as they were.
+    Simulation::StimulusGenerator::Report runStimulus(const Simulation::StimulusGenerator::Options& options);
+
+    // Checks that the other chip computes the same outputs for every input vector, both chips
+    // must have the same number of switches and outputs (see Simulation::EquivalenceChecker).
+    Simulation::EquivalenceChecker::Report checkEquivalence(Chip& other, const Simulation::EquivalenceChecker::Options& options);
+
+    // Writes the flattened netlist as C++ (see Simulation::NativeModule), and loads the
+    // compiled shared library back for simulateVectors(). The module is dropped when the chip
+    // is modified.
+    bool exportNative(const String& path);
+    bool loadNative(const String& path);
+
+    // Instances of a memoized chip are evaluated with a lookup in its truth table, instead of
+    // being inlined. Only chips with up to TruthTable::MAX_INPUTS inputs and no feedback can be
+    // memoized, others are still inlined.
+    void setMemoized(bool memoized);
+    bool isMemoized() const { return mMemoized; }
+
+    // Builds what compiling a chip that contains this one would build lazily (the truth table of
+    // a memoized chip), so such chips can then be compiled concurrently, see Scheduler.
+    void prepareInstances();
+
+    // Timing simulation (see Simulation::TimingEngine), the pins show the values at the current
+    // simulation time instead of the settled ones. The chip is compiled a second time, without
+    // optimizations, so every component keeps its own delay.
+    void startTiming(const Delays& delays);
+    void stopTiming();
+    bool isTiming() const { return mTiming; }
+    void advanceTiming(Simulation::Time duration);
+    Simulation::TimingEngine& getTimingEngine() { return mTimingEngine; }
+    const Simulation::TimingEngine& getTimingEngine() const { return mTimingEngine; }
+
+    State snapshot();
+    bool restore(const State& state);
+
+    // Runs the simulation on its own thread (see Simulation::BackgroundEngine), edits and clicks
+    // are sent to it, and sync() shows what it published. The timing simulation still runs on the
+    // calling thread.
+    void startBackground();
+    void stopBackground();
+    bool isBackground() const { return mBackground != nullptr; }
+
+    // Shows the latest state of the background simulation, once it has applied everything that
+    // was sent to it. Returns true if the pins were updated.
+    bool sync();
+
+    // Clocks (see ClockComponent) are inputs of the netlist after the switches, the clocks of
+    // the inlined chips included.
+    u32 getInputCount();
+    u32 getClockCount() const { return mClock.getClockCount(); }
+    u64 getCycle() const { return mClock.getHalfCycle() / 2; }
+
+    // Free-running clocks, at the given frequency of the base clock or as fast as possible with 0
+    // (see Simulation::ClockDriver). In background mode they run on the simulation thread,
+    // otherwise updateClocks() advances them for at most the given time, once per frame.
+    void startClocks(f64 frequency = 0.0);
+    void stopClocks();
+    bool isClockRunning() const { return mClock.isRunning(); }
+    f64 getTargetClockFrequency() const { return mClock.getTargetFrequency(); }
+    f64 getClockFrequency() const;
+    void updateClocks(f64 budgetSeconds);
+
+    // Advances the clocks by whole cycles of the base clock on the calling thread, as fast as possible.
+    void advanceClocks(u64 cycles);
+
+    // Records the switches and outputs every time the simulation finishes a tick or a half cycle of
+    // the clocks (or advances, in timing mode) into a fixed size ring buffer, which can be exported
+    // as VCD. The half cycles run by the background simulation are a single sample.
+    void startRecording(u32 capacity = Simulation::Waveform::DEFAULT_CAPACITY);
+    void stopRecording();
+    bool isRecording() const { return mRecording; }
+    const Simulation::Waveform& getWaveform() const { return mWaveform; }
+    bool exportWaveform(const String& path) const;
+
     const std::vector<Wire> getWires() const { return mWires; }
     const std::vector<Component*> getComponents() const { return mComponents; }
     const String& getName() const { return mName; }
     void setName(String name) { mName = std::move(name); }
 
-    u32 getOptimalCellSize() const { return mOptimalCellSize; }
+    // The biggest cell size that fits the whole chip in a viewport of the given size.
+    u32 getOptimalCellSize(u32 width, u32 height) const;
     u32 getIndex() const { return mIndex; }
 
     std::pair<std::vector<SwitchComponent*>, std::vector<OutputComponent*>> getPinComponents() const;
@@ -65,11 +169,44 @@ namespace Gate {
     void renderWires(Renderer3D& renderer);
     void renderGrid(Renderer3D& renderer);
 
-    ConnectionState getConnectionState(Connection& connection);
-    ConnectionResult pushWireConnection(Point position, u32 wireIndex);
-    ConnectionResult pushComponentConnection(Point position, u32 componentIndex, u32 pinIndex);
+    u32 pushConnection(Point position);
+    void compactConnections();
+
+    void extend(Point position);
+
+    // Netlist under construction, sub-chips are inlined into the netlist of the chip being compiled.
+    struct Emitter {
+      Simulation::Netlist::Builder builder;
+      std::vector<const Chip*> path;
+      std::vector<std::pair<const Chip*, u64>> dependencies;
+      std::vector<Simulation::NetId> connectionNets;
+      std::vector<u32> connectionWidths;
+      std::vector<Simulation::NetId> drivers;
+      const Delays* delays;
 
-    void calculateOptimalCellSize(Point position);
+      // Output nets and periods of the clocks, the chip's and its inlined chips'.
+      std::vector<std::pair<Simulation::NetId, u32>> clocks;
+    };
+
+    void invalidate();
+    bool isCompiled() const;
+    u32 groupConnections(std::vector<u32>& groups) const;
+    void emit(Emitter& emitter, const std::vector<Simulation::NetId>* inputs, std::vector<Simulation::NetId>& outputs) const;
+    void compile();
+    void compileTiming();
+    void compileBatch();
+    void prepareBatch();
+    Ref<const Simulation::TruthTable> getTruthTable();
+    void propagate(u32 componentIndex);
+    void updateOscillations(bool writeBackChanges);
+    void writeBack(Simulation::NetId net);
+    void writeBackTiming(Simulation::NetId net);
+    void loadBackground(std::vector<u64> state);
+    void updateRecordedNets();
+    void record(Simulation::Time elapsed);
+    // Any bit of a bus is active, every bit is valid.
+    bool isActive(Simulation::NetId net, u32 width = 1) const;
+    bool isValid(Simulation::NetId net, u32 width = 1) const;
 
   private:
     String mName;
@@ -77,11 +214,70 @@ namespace Gate {
     // Component and wire states
     std::vector<Component*> mComponents;
     std::vector<Wire> mWires;
-    std::vector<std::vector<Connection>> mConnections;
+    // Connection points are only numbered, nets are extracted from the pins and the wires (see
+    // groupConnections()). The points are numbered again when pins or wires are removed.
+    u32 mConnectionPointCount = 0;
     std::unordered_map<Point, u32> mConnectionsIndexByPoint;
 
+    // Compiled simulation program, rebuilt when the topology changes
+    bool mCompiled = false;
+    u64 mRevision = 0;
+    std::vector<std::pair<const Chip*, u64>> mDependencies;
+    Simulation::Netlist mNetlist;
+    Simulation::Engine mEngine;
+    u64 mFingerprint = 0;
+    std::vector<u32> mInputComponents;
+    std::vector<u32> mComponentInputIndexes;
+
+    // Compiled a second time on demand for the simulations that only read the outputs (vectors,
+    // faults, stimulus, equivalence, native modules and truth tables), so the logic that doesn't
+    // reach an output is removed.
+    bool mBatchCompiled = false;
+    Simulation::Netlist mBatchNetlist;
+    Simulation::Engine mBatchEngine;
+
+    // Built on demand from the compiled netlist, shared by all the instances
+    bool mMemoized = false;
+    bool mBuildingTruthTable = false;
+    Ref<const Simulation::TruthTable> mTruthTable;
+
+    // Nets of feedback loops that didn't settle, they are displayed as invalid.
+    std::vector<bool> mOscillatingNets;
+    u32 mOscillatingCount = 0;
+
+    // Timing simulation
+    bool mTiming = false;
+    Delays mDelays;
+    Simulation::Netlist mTimingNetlist;
+    Simulation::TimingEngine mTimingEngine;
+
+    // Background simulation, its frames are only shown once they are of the current netlist
+    // (generation) and include all the commands that were sent.
+    Ref<Simulation::BackgroundEngine> mBackground;
+    u64 mGeneration = 0;
+    u64 mSentCommandCount = 0;
+
+    // The pins show the state of another netlist or simulation, sync() writes back every net.
+    bool mSyncAllNets = true;
+
+    // Clocks, their half cycle follows the background simulation's.
+    Simulation::ClockDriver mClock;
+    f64 mBackgroundClockFrequency = 0.0;
+
+    // Waveform recording
+    bool mRecording = false;
+    u32 mRecordingCapacity = 0;
+    Simulation::Time mRecordTime = 0;
+    std::vector<Simulation::NetId> mRecordedNets;
+    Simulation::Waveform mWaveform;
+
+    // Pins that display the value of each net
+    std::vector<u32> mObserverOffsets;
+    std::vector<Pin*> mObservers;
+
     // Size
     u32 mOptimalCellSize;
+    Point mExtent{0, 0};
 
     u32 mIndex = 0;
   };
@@ -93,7 +289,7 @@ namespace Gate::Serializer {
   template<>
   struct Convert<Chip> {
     static Node encode(Chip& value);
-    static bool decode(const Node& node, Chip& value, Board& board);
+    static bool decode(const Node& node, Chip& value, const std::vector<Chip::Handle>& chips, const String& directory);
   };
 
 }
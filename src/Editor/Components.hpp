@@ -2,11 +2,19 @@
 
 #include "Editor/Components/Component.hpp"
 #include "Editor/Components/SwitchComponent.hpp"
+#include "Editor/Components/ClockComponent.hpp"
 #include "Editor/Components/OutputComponent.hpp"
 #include "Editor/Components/NotComponent.hpp"
 #include "Editor/Components/AndComponent.hpp"
 #include "Editor/Components/OrComponent.hpp"
 #include "Editor/Components/XorComponent.hpp"
+#include "Editor/Components/DFlipFlopComponent.hpp"
+#include "Editor/Components/RegisterComponent.hpp"
+#include "Editor/Components/RamComponent.hpp"
+#include "Editor/Components/RomComponent.hpp"
+#include "Editor/Components/SplitterComponent.hpp"
+#include "Editor/Components/MergerComponent.hpp"
+#include "Editor/Components/WordComponent.hpp"
 
 #include "Editor/Components/ChipComponent.hpp"
 
@@ -30,31 +30,11 @@ namespace Gate {
     auto width = std::max(this->mChipInputs.size(), this->mChipOutputs.size());
     renderer.drawCenteredQuad((mPosition.toVec2() + Vec2{0.0f, f32(width) / 2.0f - 0.5f}) * (f32)config.grid.cell.size, size * 1.8f * Vec2{1.0f, f32(width) / 2.0f + 0.5f}, color);
   }
-  bool ChipComponent::update() {
-    for (usize i = 0; i < mChipInputs.size(); ++i) {
-      mChipInputs[i]->getOutputPins()[SwitchComponent::OUTPUT_INDEX].active = mInputPins[i].active;
-    }
-
-    mChip->tick();
-
-    for (usize i = 0; i < mChipOutputs.size(); ++i) {
-      mOutputPins[i].active = mChipOutputs[i]->getInputPins()[OutputComponent::INPUT_INDEX].active;
-    }
-
-    return true;
-  }
-
   void ChipComponent::renderBody(Renderer3D& renderer, u32 id) {
     Material::Handle material = config.inactiveMaterial;
     auto width = std::max(this->mChipInputs.size(), this->mChipOutputs.size());
     
-    f32 size = 1.5f;
-
-    Vec3 position = mPosition.toVec3() * config.grid.cell.size3d * Vec3{1.0f, -1.0f, 0.0f} + Vec3{0.0f, 0.0f, config._3dZOffset};
-    Mat4 model = glm::translate(Mat4{1.0f}, position);
-
-    size = config.grid.cell.size3d * size;
-    model = glm::scale(model, Vec3(size, size * width, size));
+    const auto model = Component::computeModel(1.5f, f32(width));
 
     renderer.submit(config.pinMesh, material, model, id);
   }
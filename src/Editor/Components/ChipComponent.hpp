@@ -17,12 +17,13 @@ namespace Gate {
   class ChipComponent : public Component {
   public:
     ChipComponent(Point position, Ref<Chip> chip);
-    virtual bool update() override;
     virtual void renderBody(Renderer2D& renderer) override;
     virtual void renderBody(Renderer3D& renderer, u32 id) override;
     virtual void renderConnectors(Renderer3D&, [[maybe_unused]] u32 id) override {}
 
     virtual Serializer::Node encode() const override;
+
+    inline const Ref<Chip>& getChip() const { return mChip; }
   
   private:
     Ref<Chip> mChip = nullptr;
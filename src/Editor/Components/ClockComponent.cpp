@@ -0,0 +1,53 @@
+#include "Application.hpp"
+#include "Editor/Config.hpp"
+#include "Editor/Components/Component.hpp"
+
+namespace Gate {
+
+  ClockComponent::ClockComponent(Point position, u32 period)
+    : Component(Component::Category::Input, Type::Clock, position)
+  {
+    this->mOutputPins.push_back(Pin{Point{position.x + 1, position.y}});
+    setPeriod(period);
+  }
+
+  void ClockComponent::setPeriod(u32 period) {
+    mPeriod = std::clamp(period, 1u, MAX_PERIOD);
+  }
+
+  void ClockComponent::renderBody(Renderer2D& renderer) {
+    Vec2 size = Vec2{(f32)config.grid.cell.size};
+    Vec4 color = Color::BLACK;
+    if (mOutputPins[OUTPUT_INDEX].active) {
+      color = Color::RED;
+    }
+    const auto position = mPosition.toVec2() * (f32)config.grid.cell.size;
+    renderer.drawCenteredQuad(position, size * 1.5f, color);
+    renderer.drawCenteredQuad(position, size * 0.5f, Color::WHITE);
+  }
+  void ClockComponent::click() {
+    setPeriod(mPeriod >= MAX_PERIOD ? 1 : mPeriod * 2);
+  }
+
+  void ClockComponent::renderBody(Renderer3D& renderer, u32 id) {
+    Material::Handle material = config.inactiveMaterial;
+    if (mOutputPins[OUTPUT_INDEX].active) {
+      material = config.activeMaterial;
+    }
+
+    const auto model = Component::computeModel(1.5f);
+
+    renderer.submit(config.pinMesh, material, model, id);
+  }
+
+  Serializer::Node ClockComponent::encode() const {
+    using namespace Serializer;
+
+    auto node = Node::object();
+    node["type"]     = String("ClockComponent");
+    node["position"] = Convert<Point>::encode(mPosition);
+    node["period"]   = mPeriod;
+    return node;
+  }
+
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "Core/Base.hpp"
+#include "Editor/Point.hpp"
+#include "Renderer/Renderer2D.hpp"
+
+#include "Editor/Components/Component.hpp"
+
+namespace Gate {
+
+  // A clock source, its period is in cycles of the base clock (see Simulation::ClockDriver).
+  // Clicking it doubles the period, up to MAX_PERIOD.
+  class ClockComponent : public Component {
+  public:
+    static const constexpr u32 OUTPUT_INDEX = 0;
+    static const constexpr u32 MAX_PERIOD = 1 << 10;
+
+  public:
+    ClockComponent(Point position, u32 period = 1);
+    virtual void click() override;
+    virtual void renderBody(Renderer2D& renderer) override;
+    virtual void renderBody(Renderer3D& renderer, u32 id) override;
+
+    virtual Serializer::Node encode() const override;
+
+    inline u32 getPeriod() const { return mPeriod; }
+    void setPeriod(u32 period);
+
+  private:
+    u32 mPeriod = 1;
+  };
+
+}
@@ -11,11 +11,15 @@ namespace Gate {
   Component::~Component() {}
 
   Mat4 Component::computeModel(f32 size) const {
+    return computeModel(size, 1.0f);
+  }
+
+  Mat4 Component::computeModel(f32 size, f32 height) const {
     Vec3 position = mPosition.toVec3() * config.grid.cell.size3d * Vec3{1.0f, -1.0f, 0.0f} + Vec3{0.0f, 0.0f, config._3dZOffset};
     Mat4 model = glm::translate(Mat4{1.0f}, position);
 
     size = config.grid.cell.size3d * size;
-    model = glm::scale(model, Vec3(size));
+    model = glm::scale(model, Vec3(size, size * height, size));
     return model;
   }
 
@@ -28,23 +32,6 @@ namespace Gate {
       pin.render(renderer, true);
     }
   }
-  void Component::resetVisited() {
-    setVisited(false);
-    for (auto& pin : mInputPins) {
-      pin.visited = false;
-    }
-    for (auto& pin : mOutputPins) {
-      pin.visited = false;
-    }
-  }
-  bool Component::areAllInputPinsVisited() const {
-    for (auto& pin : mInputPins) {
-      if (!pin.visited) {
-        return false;
-      }
-    }
-    return true;
-  }
 
   void Component::renderConnectors(Renderer3D& renderer, u32 id) {
     for (auto& pin : mInputPins) {
@@ -55,7 +42,7 @@ namespace Gate {
     }
   }
 
-  Component* Component::decode(const Serializer::Node& node, Board& board) {
+  Component* Component::decode(const Serializer::Node& node, const std::vector<Ref<Chip>>& chips, const String& directory) {
     using namespace Serializer;
     if (!node.isObject()) return nullptr;
 
@@ -72,6 +59,12 @@ namespace Gate {
       auto& type = *typeNode->asString();
       if (type == "SwitchComponent") {
         return new SwitchComponent(position);
+      } else if (type == "ClockComponent") {
+        u32 period = 1;
+        if (auto* periodNode = node.get("period"); periodNode && !Convert<u32>::decode(*periodNode, period)) {
+          return nullptr;
+        }
+        return new ClockComponent(position, period);
       } else if (type == "OutputComponent") {
         return new OutputComponent(position);
       } else if (type == "AndComponent") {
@@ -82,6 +75,73 @@ namespace Gate {
         return new XorComponent(position);
       } else if (type == "NotComponent") {
         return new NotComponent(position);
+      } else if (type == "DFlipFlopComponent") {
+        return new DFlipFlopComponent(position);
+      } else if (type == "RegisterComponent") {
+        u32 width = RegisterComponent::DEFAULT_WIDTH;
+        if (auto* widthNode = node.get("width"); widthNode && !Convert<u32>::decode(*widthNode, width)) {
+          return nullptr;
+        }
+        return new RegisterComponent(position, width);
+      } else if (type == "RamComponent" || type == "RomComponent") {
+        u32 addressWidth = RamComponent::DEFAULT_ADDRESS_WIDTH;
+        u32 dataWidth = RamComponent::DEFAULT_DATA_WIDTH;
+        if (auto* addressNode = node.get("address"); addressNode && !Convert<u32>::decode(*addressNode, addressWidth)) {
+          return nullptr;
+        }
+        if (auto* dataNode = node.get("data"); dataNode && !Convert<u32>::decode(*dataNode, dataWidth)) {
+          return nullptr;
+        }
+        if (type == "RamComponent") {
+          return new RamComponent(position, addressWidth, dataWidth);
+        }
+
+        // The contents are either in the board or in a binary file next to it, the file is kept
+        // so the ROM can be reloaded.
+        auto* rom = new RomComponent(position, addressWidth, dataWidth);
+        auto* fileNode = node.get("file");
+        if (fileNode) {
+          if (!fileNode->isString()) {
+            delete rom;
+            return nullptr;
+          }
+          rom->setFile(*fileNode->asString(), directory);
+        }
+        if (auto* contentsNode = node.get("contents"); contentsNode) {
+          std::vector<u8> contents;
+          if (!Convert<std::vector<u8>>::decode(*contentsNode, contents)) {
+            delete rom;
+            return nullptr;
+          }
+          rom->setContents(std::move(contents));
+        } else if (fileNode && !rom->reload()) {
+          delete rom;
+          return nullptr;
+        }
+        return rom;
+      } else if (type == "SplitterComponent" || type == "MergerComponent") {
+        u32 width = SplitterComponent::DEFAULT_WIDTH;
+        if (auto* widthNode = node.get("width"); widthNode && !Convert<u32>::decode(*widthNode, width)) {
+          return nullptr;
+        }
+        if (type == "SplitterComponent") {
+          return new SplitterComponent(position, width);
+        }
+        return new MergerComponent(position, width);
+      } else if (type == "WordAndComponent" || type == "WordOrComponent" || type == "WordXorComponent" || type == "WordAddComponent") {
+        u32 width = WordComponent::DEFAULT_WIDTH;
+        if (auto* widthNode = node.get("width"); widthNode && !Convert<u32>::decode(*widthNode, width)) {
+          return nullptr;
+        }
+        Type wordType = Type::WordAdd;
+        if (type == "WordAndComponent") {
+          wordType = Type::WordAnd;
+        } else if (type == "WordOrComponent") {
+          wordType = Type::WordOr;
+        } else if (type == "WordXorComponent") {
+          wordType = Type::WordXor;
+        }
+        return new WordComponent(position, wordType, width);
       } else if (type == "ChipComponent") {
         auto* chipIndex = node.get("chip");
         if (!chipIndex) {
@@ -89,8 +149,11 @@ namespace Gate {
         }
         Node::Integer index;
         if (!Convert<Node::Integer>::decode(*chipIndex, index)) return nullptr;
-        // Logger::info("-------------------------------- %u", index);
-        return new ChipComponent(position, board.getChips()[index]);
+        if (index < 0 || (usize)index >= chips.size()) {
+          Logger::error("Json: invalid chip index: %lld", (long long)index);
+          return nullptr;
+        }
+        return new ChipComponent(position, chips[index]);
       } else {
         Logger::error("Json: invalid component type: %s", type.c_str());
         return nullptr;
@@ -11,7 +11,7 @@ class Component;
 
 namespace Gate {
 
-  class Board;
+  class Chip;
 
 #define GATE_COMPONENT_IMPLEMENTATION(name)               \
   Serializer::Node name::encode() const {                 \
@@ -32,6 +32,7 @@ namespace Gate {
 
     enum class Type {
       Switch,
+      Clock,
       Output,
 
       AndGate,
@@ -39,6 +40,18 @@ namespace Gate {
       XorGate,
       NotGate,
 
+      FlipFlop,
+      Register,
+      Ram,
+      Rom,
+
+      Splitter,
+      Merger,
+      WordAnd,
+      WordOr,
+      WordXor,
+      WordAdd,
+
       Chip,
     };
 
@@ -49,20 +62,16 @@ namespace Gate {
     inline std::vector<Pin>& getOutputPins() { return mOutputPins; }
     inline const std::vector<Pin>& getOutputPins() const { return mOutputPins; }
 
-    inline bool isVisited() const { return mVisited; }
-    inline void setVisited(bool value) { mVisited = value; }
-    bool areAllInputPinsVisited() const;
-    void resetVisited();
-
     inline Category getCategory() const { return mCategory; }
     inline Type getType() const { return mType; }
 
     Mat4 computeModel(f32 size) const;
+    // Stretched vertically, for the components with a row of pins.
+    Mat4 computeModel(f32 size, f32 height) const;
 
   public:
     virtual ~Component();
     virtual void click() {}
-    virtual bool update() = 0;
     virtual bool deletable() { return true; };
     virtual void setDeletable(bool value) { (void)value; }
 
@@ -73,7 +82,8 @@ namespace Gate {
     virtual void renderConnectors(Renderer3D&, u32 id);
 
     virtual Serializer::Node encode() const = 0;
-    static Component* decode(const Serializer::Node& node, Board& value);
+    // Files referenced by the component are relative to the directory (of the board).
+    static Component* decode(const Serializer::Node& node, const std::vector<Ref<Chip>>& chips, const String& directory);
 
   protected:
     Component(Category category, Type type, Point position)
@@ -87,8 +97,6 @@ namespace Gate {
     Point mPosition;
     std::vector<Pin> mInputPins;
     std::vector<Pin> mOutputPins;
-
-    bool mVisited = false;
   };
 
 }
@@ -0,0 +1,35 @@
+#include "Application.hpp"
+#include "Editor/Config.hpp"
+#include "Editor/Components/Component.hpp"
+
+namespace Gate {
+
+  DFlipFlopComponent::DFlipFlopComponent(Point position)
+    : Component(Component::Category::Gate, Type::FlipFlop, position)
+  {
+    this->mInputPins.push_back(Pin{Point{position.x - 1, position.y}});
+    this->mInputPins.push_back(Pin{Point{position.x - 1, position.y + 1}});
+    this->mOutputPins.push_back(Pin{Point{position.x + 1, position.y}});
+  }
+  void DFlipFlopComponent::renderBody(Renderer2D& renderer) {
+    Vec2 size = Vec2{(f32)config.grid.cell.size};
+    Vec4 color = Color::BLACK;
+    if (mOutputPins[OUTPUT_INDEX].active) {
+      color = Color::RED;
+    }
+    renderer.drawCenteredQuad((mPosition.toVec2() + Vec2{0.0f, 0.5f}) * (f32)config.grid.cell.size, size * Vec2{1.8f, 2.0f}, color);
+  }
+  void DFlipFlopComponent::renderBody(Renderer3D& renderer, u32 id) {
+    Material::Handle material = config.inactiveMaterial;
+    if (mOutputPins[OUTPUT_INDEX].active) {
+      material = config.activeMaterial;
+    }
+
+    const auto model = Component::computeModel(1.5f);
+
+    renderer.submit(config.pinMesh, material, model, id);
+  }
+
+  GATE_COMPONENT_IMPLEMENTATION(DFlipFlopComponent)
+
+}
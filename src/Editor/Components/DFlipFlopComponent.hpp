@@ -0,0 +1,26 @@
+#pragma once
+
+#include "Core/Base.hpp"
+#include "Editor/Point.hpp"
+#include "Renderer/Renderer2D.hpp"
+
+#include "Editor/Components/Component.hpp"
+
+namespace Gate {
+
+  // Edge-triggered D flip-flop, the output takes the value of D when CLK rises.
+  class DFlipFlopComponent : public Component {
+  public:
+    static const constexpr u32 D_INPUT_INDEX     = 0;
+    static const constexpr u32 CLOCK_INPUT_INDEX = 1;
+    static const constexpr u32 OUTPUT_INDEX      = 0;
+
+  public:
+    DFlipFlopComponent(Point position);
+    virtual void renderBody(Renderer2D& renderer) override;
+    virtual void renderBody(Renderer3D& renderer, u32 id) override;
+
+    virtual Serializer::Node encode() const override;
+  };
+
+}
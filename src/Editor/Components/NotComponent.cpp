@@ -18,11 +18,6 @@ namespace Gate {
     }
     renderer.drawCenteredQuad(mPosition.toVec2() * (f32)config.grid.cell.size, size * 1.9f, config.notGate, color);
   }
-  bool NotComponent::update() {
-    mOutputPins[OUTPUT_INDEX].active = !mInputPins[INPUT_INDEX].active;
-    return true;
-  }
-
   void NotComponent::renderBody(Renderer3D& renderer, u32 id) {
     Material::Handle material = config.inactiveMaterial;
     if (mOutputPins[OUTPUT_INDEX].active) {
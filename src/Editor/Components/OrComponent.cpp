@@ -19,11 +19,6 @@ namespace Gate {
     }
     renderer.drawCenteredQuad(mPosition.toVec2() * (f32)config.grid.cell.size, Vec2{size.x * 2.2f, size.y * 2.4f}, config.orGate, color);
   }
-  bool OrComponent::update() {
-    mOutputPins[OUTPUT_INDEX].active = mInputPins[A_INPUT_INDEX].active || mInputPins[B_INPUT_INDEX].active;
-    return true;
-  }
-
   void OrComponent::renderBody(Renderer3D& renderer, u32 id) {
     Material::Handle material = config.inactiveMaterial;
     if (mOutputPins[OUTPUT_INDEX].active) {
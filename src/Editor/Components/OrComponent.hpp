@@ -15,7 +15,6 @@ namespace Gate {
     static const constexpr u32 OUTPUT_INDEX  = 0;
   public:
     OrComponent(Point position);
-    virtual bool update() override;
     virtual void renderBody(Renderer2D& renderer) override;
     virtual void renderBody(Renderer3D& renderer, u32 id) override;
 
@@ -26,10 +26,6 @@ namespace Gate {
     renderer.drawCenteredQuad(mPosition.toVec2() * (f32)config.grid.cell.size, size * 1.5f, color);
   }
 
-  bool OutputComponent::update() {
-    return true;
-  }
-
   void OutputComponent::renderBody(Renderer3D& renderer, u32 id) {
     Material::Handle material = config.inactiveMaterial;
     if (mInputPins[INPUT_INDEX].active) {
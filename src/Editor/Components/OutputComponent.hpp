@@ -13,7 +13,6 @@ namespace Gate {
     static const constexpr u32 INPUT_INDEX = 0;
   public:
     OutputComponent(Point position);
-    virtual bool update() override;
     virtual bool deletable() override;
     virtual void setDeletable(bool value) override;
     virtual void renderBody(Renderer2D& renderer) override;
@@ -0,0 +1,47 @@
+#include "Application.hpp"
+#include "Editor/Config.hpp"
+#include "Editor/Components/Component.hpp"
+#include "Simulation/Netlist.hpp"
+
+namespace Gate {
+
+  RamComponent::RamComponent(Point position, u32 addressWidth, u32 dataWidth)
+    : Component(Component::Category::Gate, Type::Ram, position)
+  {
+    addressWidth = std::clamp(addressWidth, 1u, Simulation::Memory::MAX_ADDRESS_WIDTH);
+    dataWidth = std::clamp(dataWidth, 1u, Simulation::Memory::MAX_DATA_WIDTH);
+    const u32 inputCount = addressWidth + dataWidth + 2;
+    for (u32 i = 0; i < inputCount; ++i) {
+      this->mInputPins.push_back(Pin{Point{position.x - 1, position.y + i}});
+    }
+    for (u32 i = 0; i < dataWidth; ++i) {
+      this->mOutputPins.push_back(Pin{Point{position.x + 1, position.y + i}});
+    }
+  }
+  void RamComponent::renderBody(Renderer2D& renderer) {
+    Vec2 size = Vec2{(f32)config.grid.cell.size};
+    Vec4 color = Color::BLACK;
+    const f32 height = f32(mInputPins.size());
+    renderer.drawCenteredQuad((mPosition.toVec2() + Vec2{0.0f, height / 2.0f - 0.5f}) * (f32)config.grid.cell.size, size * 1.8f * Vec2{1.0f, height / 2.0f + 0.5f}, color);
+  }
+  void RamComponent::renderBody(Renderer3D& renderer, u32 id) {
+    Material::Handle material = config.inactiveMaterial;
+    const f32 height = f32(mInputPins.size());
+
+    const auto model = Component::computeModel(1.5f, height);
+
+    renderer.submit(config.pinMesh, material, model, id);
+  }
+
+  Serializer::Node RamComponent::encode() const {
+    using namespace Serializer;
+
+    auto node = Node::object();
+    node["type"]     = String("RamComponent");
+    node["position"] = Convert<Point>::encode(mPosition);
+    node["address"]  = getAddressWidth();
+    node["data"]     = getDataWidth();
+    return node;
+  }
+
+}
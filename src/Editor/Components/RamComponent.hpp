@@ -0,0 +1,34 @@
+#pragma once
+
+#include "Core/Base.hpp"
+#include "Editor/Point.hpp"
+#include "Renderer/Renderer2D.hpp"
+
+#include "Editor/Components/Component.hpp"
+
+namespace Gate {
+
+  // A random-access memory, the outputs are the word at the address, and the data inputs are
+  // written at the address when CLK rises while WE is high. It holds zeros at power on.
+  //
+  // From the top, the inputs are the address, the data, WE and CLK.
+  class RamComponent : public Component {
+  public:
+    static const constexpr u32 DEFAULT_ADDRESS_WIDTH = 4;
+    static const constexpr u32 DEFAULT_DATA_WIDTH = 8;
+
+  public:
+    RamComponent(Point position, u32 addressWidth = DEFAULT_ADDRESS_WIDTH, u32 dataWidth = DEFAULT_DATA_WIDTH);
+    virtual void renderBody(Renderer2D& renderer) override;
+    virtual void renderBody(Renderer3D& renderer, u32 id) override;
+
+    virtual Serializer::Node encode() const override;
+
+    inline u32 getAddressWidth() const { return (u32)mInputPins.size() - getDataWidth() - 2; }
+    inline u32 getDataWidth() const { return (u32)mOutputPins.size(); }
+    inline u32 getDataInputIndex(u32 bit) const { return getAddressWidth() + bit; }
+    inline u32 getWriteInputIndex() const { return getAddressWidth() + getDataWidth(); }
+    inline u32 getClockInputIndex() const { return getWriteInputIndex() + 1; }
+  };
+
+}
@@ -0,0 +1,42 @@
+#include "Application.hpp"
+#include "Editor/Config.hpp"
+#include "Editor/Components/Component.hpp"
+
+namespace Gate {
+
+  RegisterComponent::RegisterComponent(Point position, u32 width)
+    : Component(Component::Category::Gate, Type::Register, position)
+  {
+    width = std::clamp(width, 1u, MAX_WIDTH);
+    for (u32 i = 0; i < width; ++i) {
+      this->mInputPins.push_back(Pin{Point{position.x - 1, position.y + i}});
+      this->mOutputPins.push_back(Pin{Point{position.x + 1, position.y + i}});
+    }
+    this->mInputPins.push_back(Pin{Point{position.x - 1, position.y + width}});
+  }
+  void RegisterComponent::renderBody(Renderer2D& renderer) {
+    Vec2 size = Vec2{(f32)config.grid.cell.size};
+    Vec4 color = Color::BLACK;
+    const f32 height = f32(getWidth() + 1);
+    renderer.drawCenteredQuad((mPosition.toVec2() + Vec2{0.0f, height / 2.0f - 0.5f}) * (f32)config.grid.cell.size, size * 1.8f * Vec2{1.0f, height / 2.0f + 0.5f}, color);
+  }
+  void RegisterComponent::renderBody(Renderer3D& renderer, u32 id) {
+    Material::Handle material = config.inactiveMaterial;
+    const f32 height = f32(getWidth() + 1);
+
+    const auto model = Component::computeModel(1.5f, height);
+
+    renderer.submit(config.pinMesh, material, model, id);
+  }
+
+  Serializer::Node RegisterComponent::encode() const {
+    using namespace Serializer;
+
+    auto node = Node::object();
+    node["type"]     = String("RegisterComponent");
+    node["position"] = Convert<Point>::encode(mPosition);
+    node["width"]    = getWidth();
+    return node;
+  }
+
+}
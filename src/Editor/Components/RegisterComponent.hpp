@@ -0,0 +1,29 @@
+#pragma once
+
+#include "Core/Base.hpp"
+#include "Editor/Point.hpp"
+#include "Renderer/Renderer2D.hpp"
+
+#include "Editor/Components/Component.hpp"
+
+namespace Gate {
+
+  // A row of D flip-flops sharing a clock, output i takes the value of input i when CLK rises.
+  // The clock is the input below the data inputs.
+  class RegisterComponent : public Component {
+  public:
+    static const constexpr u32 DEFAULT_WIDTH = 8;
+    static const constexpr u32 MAX_WIDTH = 64;
+
+  public:
+    RegisterComponent(Point position, u32 width = DEFAULT_WIDTH);
+    virtual void renderBody(Renderer2D& renderer) override;
+    virtual void renderBody(Renderer3D& renderer, u32 id) override;
+
+    virtual Serializer::Node encode() const override;
+
+    inline u32 getWidth() const { return (u32)mOutputPins.size(); }
+    inline u32 getClockInputIndex() const { return getWidth(); }
+  };
+
+}
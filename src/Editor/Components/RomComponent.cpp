@@ -0,0 +1,81 @@
+#include "Application.hpp"
+#include "Editor/Config.hpp"
+#include "Editor/Components/Component.hpp"
+#include "Simulation/Netlist.hpp"
+#include "Utils/File.hpp"
+
+namespace Gate {
+
+  RomComponent::RomComponent(Point position, u32 addressWidth, u32 dataWidth)
+    : Component(Component::Category::Gate, Type::Rom, position)
+  {
+    addressWidth = std::clamp(addressWidth, 1u, Simulation::Memory::MAX_ADDRESS_WIDTH);
+    dataWidth = std::clamp(dataWidth, 1u, Simulation::Memory::MAX_DATA_WIDTH);
+    for (u32 i = 0; i < addressWidth; ++i) {
+      this->mInputPins.push_back(Pin{Point{position.x - 1, position.y + i}});
+    }
+    for (u32 i = 0; i < dataWidth; ++i) {
+      this->mOutputPins.push_back(Pin{Point{position.x + 1, position.y + i}});
+    }
+  }
+  void RomComponent::renderBody(Renderer2D& renderer) {
+    Vec2 size = Vec2{(f32)config.grid.cell.size};
+    Vec4 color = Color::BLACK;
+    const f32 height = f32(std::max(getAddressWidth(), getDataWidth()));
+    renderer.drawCenteredQuad((mPosition.toVec2() + Vec2{0.0f, height / 2.0f - 0.5f}) * (f32)config.grid.cell.size, size * 1.8f * Vec2{1.0f, height / 2.0f + 0.5f}, color);
+  }
+  void RomComponent::click() {
+    if (reload()) {
+      Logger::info("Loaded '%s' into a ROM of %u words of %u bits", mFile.c_str(), 1u << getAddressWidth(), getDataWidth());
+    }
+  }
+
+  void RomComponent::setContents(std::vector<u8> contents) {
+    contents.resize(Simulation::Memory::getByteCount(getAddressWidth(), getDataWidth()), 0);
+    mContents = std::make_shared<const std::vector<u8>>(std::move(contents));
+  }
+
+  bool RomComponent::loadContents(const StringView& filename) {
+    std::vector<u8> contents;
+    if (!Utils::fileToBytes(filename, contents)) {
+      return false;
+    }
+    setContents(std::move(contents));
+    return true;
+  }
+
+  bool RomComponent::reload() {
+    if (mFile.empty()) {
+      Logger::warn("The ROM at (%u, %u) has no file to load", mPosition.x, mPosition.y);
+      return false;
+    }
+    return loadContents(Utils::resolvePath(mDirectory, mFile));
+  }
+
+  void RomComponent::renderBody(Renderer3D& renderer, u32 id) {
+    Material::Handle material = config.inactiveMaterial;
+    const f32 height = f32(std::max(getAddressWidth(), getDataWidth()));
+
+    const auto model = Component::computeModel(1.5f, height);
+
+    renderer.submit(config.pinMesh, material, model, id);
+  }
+
+  Serializer::Node RomComponent::encode() const {
+    using namespace Serializer;
+
+    auto node = Node::object();
+    node["type"]     = String("RomComponent");
+    node["position"] = Convert<Point>::encode(mPosition);
+    node["address"]  = getAddressWidth();
+    node["data"]     = getDataWidth();
+    if (!mFile.empty()) {
+      node["file"] = mFile;
+    }
+    if (mContents) {
+      node["contents"] = Convert<std::vector<u8>>::encode(*mContents);
+    }
+    return node;
+  }
+
+}
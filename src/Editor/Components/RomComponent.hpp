@@ -0,0 +1,52 @@
+#pragma once
+
+#include "Core/Base.hpp"
+#include "Editor/Point.hpp"
+#include "Renderer/Renderer2D.hpp"
+
+#include "Editor/Components/Component.hpp"
+
+#include <vector>
+
+namespace Gate {
+
+  // A read-only memory, the outputs are the word at the address of the inputs.
+  //
+  // The words are packed at getDataWidth() bits each from the lowest bit of the first byte, so
+  // the image of a ROM of 8-bit words is a plain binary file. Clicking it reloads its file.
+  class RomComponent : public Component {
+  public:
+    static const constexpr u32 DEFAULT_ADDRESS_WIDTH = 4;
+    static const constexpr u32 DEFAULT_DATA_WIDTH = 8;
+
+  public:
+    RomComponent(Point position, u32 addressWidth = DEFAULT_ADDRESS_WIDTH, u32 dataWidth = DEFAULT_DATA_WIDTH);
+    virtual void click() override;
+    virtual void renderBody(Renderer2D& renderer) override;
+    virtual void renderBody(Renderer3D& renderer, u32 id) override;
+
+    virtual Serializer::Node encode() const override;
+
+    inline u32 getAddressWidth() const { return (u32)mInputPins.size(); }
+    inline u32 getDataWidth() const { return (u32)mOutputPins.size(); }
+
+    // nullptr when every word is 0.
+    inline const Ref<const std::vector<u8>>& getContents() const { return mContents; }
+
+    // Truncated or padded with zeros to the size of the memory.
+    void setContents(std::vector<u8> contents);
+    bool loadContents(const StringView& filename);
+
+    // The binary file the contents are reloaded from, "" if they only are in the board. It is
+    // kept as written in the board, and only resolved against the directory when it is loaded.
+    inline const String& getFile() const { return mFile; }
+    inline void setFile(String file, String directory) { mFile = std::move(file); mDirectory = std::move(directory); }
+    bool reload();
+
+  private:
+    Ref<const std::vector<u8>> mContents;
+    String mFile;
+    String mDirectory;
+  };
+
+}
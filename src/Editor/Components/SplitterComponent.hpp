@@ -0,0 +1,27 @@
+#pragma once
+
+#include "Core/Base.hpp"
+#include "Editor/Point.hpp"
+#include "Renderer/Renderer2D.hpp"
+
+#include "Editor/Components/Component.hpp"
+
+namespace Gate {
+
+  // Splits the bus of its input, output i is bit i.
+  class SplitterComponent : public Component {
+  public:
+    static const constexpr u32 INPUT_INDEX = 0;
+    static const constexpr u32 DEFAULT_WIDTH = 8;
+
+  public:
+    SplitterComponent(Point position, u32 width = DEFAULT_WIDTH);
+    virtual void renderBody(Renderer2D& renderer) override;
+    virtual void renderBody(Renderer3D& renderer, u32 id) override;
+
+    virtual Serializer::Node encode() const override;
+
+    inline u32 getWidth() const { return (u32)mOutputPins.size(); }
+  };
+
+}
@@ -25,9 +25,6 @@ namespace Gate {
     }
     renderer.drawCenteredQuad(mPosition.toVec2() * (f32)config.grid.cell.size, size * 1.5f, color);
   }
-  bool SwitchComponent::update() {
-    return true;
-  }
   void SwitchComponent::click() {
     this->toggle();
   }
@@ -13,7 +13,6 @@ namespace Gate {
     static const constexpr u32 OUTPUT_INDEX = 0;
   public:
     SwitchComponent(Point position);
-    virtual bool update() override;
     virtual void click() override;
     virtual bool deletable() override;
     virtual void setDeletable(bool value) override;
@@ -0,0 +1,52 @@
+#include "Application.hpp"
+#include "Editor/Config.hpp"
+#include "Editor/Components/Component.hpp"
+
+namespace Gate {
+
+  WordComponent::WordComponent(Point position, Type type, u32 width)
+    : Component(Component::Category::Gate, type, position)
+  {
+    GATE_DEBUG_ASSERT(type == Type::WordAnd || type == Type::WordOr || type == Type::WordXor || type == Type::WordAdd);
+    width = std::clamp(width, 1u, Pin::MAX_WIDTH);
+    this->mInputPins.push_back(Pin{Point{position.x - 1, position.y}, width});
+    this->mInputPins.push_back(Pin{Point{position.x - 1, position.y + 1}, width});
+    this->mOutputPins.push_back(Pin{Point{position.x + 1, position.y}, width});
+    if (type == Type::WordAdd) {
+      this->mOutputPins.push_back(Pin{Point{position.x + 1, position.y + 1}});
+    }
+  }
+  void WordComponent::renderBody(Renderer2D& renderer) {
+    Vec2 size = Vec2{(f32)config.grid.cell.size};
+    Vec4 color = Color::BLACK;
+    const f32 height = 2.0f;
+    renderer.drawCenteredQuad((mPosition.toVec2() + Vec2{0.0f, height / 2.0f - 0.5f}) * (f32)config.grid.cell.size, size * 1.8f * Vec2{1.0f, height / 2.0f + 0.5f}, color);
+  }
+  void WordComponent::renderBody(Renderer3D& renderer, u32 id) {
+    Material::Handle material = config.inactiveMaterial;
+    const f32 height = 2.0f;
+
+    const auto model = Component::computeModel(1.5f, height);
+
+    renderer.submit(config.pinMesh, material, model, id);
+  }
+
+  const char* WordComponent::getTypeName(Type type) {
+    if (type == Type::WordAnd) return "WordAndComponent";
+    if (type == Type::WordOr)  return "WordOrComponent";
+    if (type == Type::WordXor) return "WordXorComponent";
+    if (type == Type::WordAdd) return "WordAddComponent";
+    GATE_UNREACHABLE("not a word component type");
+  }
+
+  Serializer::Node WordComponent::encode() const {
+    using namespace Serializer;
+
+    auto node = Node::object();
+    node["type"]     = String(getTypeName(mType));
+    node["position"] = Convert<Point>::encode(mPosition);
+    node["width"]    = getWidth();
+    return node;
+  }
+
+}
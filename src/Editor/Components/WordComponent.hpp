@@ -0,0 +1,35 @@
+#pragma once
+
+#include "Core/Base.hpp"
+#include "Editor/Point.hpp"
+#include "Renderer/Renderer2D.hpp"
+
+#include "Editor/Components/Component.hpp"
+
+namespace Gate {
+
+  // A bitwise AND, OR or XOR, or an addition of two buses. The type is one of the Word types.
+  //
+  // The addition wraps around, its carry is the output below the sum. They are compiled to
+  // gates bit by bit, see Chip::emit().
+  class WordComponent : public Component {
+  public:
+    static const constexpr u32 A_INPUT_INDEX = 0;
+    static const constexpr u32 B_INPUT_INDEX = 1;
+    static const constexpr u32 OUTPUT_INDEX  = 0;
+    static const constexpr u32 CARRY_INDEX   = 1;
+    static const constexpr u32 DEFAULT_WIDTH = 8;
+
+  public:
+    WordComponent(Point position, Type type, u32 width = DEFAULT_WIDTH);
+    virtual void renderBody(Renderer2D& renderer) override;
+    virtual void renderBody(Renderer3D& renderer, u32 id) override;
+
+    virtual Serializer::Node encode() const override;
+
+    inline u32 getWidth() const { return mOutputPins[OUTPUT_INDEX].width; }
+
+    static const char* getTypeName(Type type);
+  };
+
+}
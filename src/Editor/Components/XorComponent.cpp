@@ -22,11 +22,6 @@ namespace Gate {
     // f32 fontSize = size.x * 1.5f;
     // renderer.drawText("X", (mPosition.toVec2() * (f32)config.grid.cell.size) - fontSize / 2.0f, fontSize, Color::PURPLE);
   }
-  bool XorComponent::update() {
-    mOutputPins[OUTPUT_INDEX].active = mInputPins[A_INPUT_INDEX].active != mInputPins[B_INPUT_INDEX].active;
-    return true;
-  }
-
   void XorComponent::renderBody(Renderer3D& renderer, u32 id) {
     Material::Handle material = config.inactiveMaterial;
     if (mOutputPins[OUTPUT_INDEX].active) {
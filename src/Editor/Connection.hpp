@@ -1,40 +0,0 @@
-#pragma once
-
-#include "Core/Base.hpp"
-
-namespace Gate {
-  
-  struct Connection {
-    enum Type {
-      Component,
-      Wire,
-    };
-
-    Type type;
-    u32 index;
-    u32 componentIndex = UINT32_MAX;
-  };
-
-  struct ConnectionResult {
-    bool successful;
-    u32  connectionIndex;
-
-    ConnectionResult()
-      : successful{false}, connectionIndex{UINT32_MAX}
-    {}
-    ConnectionResult(u32 index)
-      : successful{true}, connectionIndex{index}
-    {}
-  };
-
-  struct ConnectionState {
-    bool active = false;
-    bool visited = false;
-
-    ConnectionState() = default;
-    ConnectionState(bool active_, bool visited_)
-      : active{active_}, visited{visited_}
-    {}
-  };
-
-}
\ No newline at end of file
@@ -0,0 +1,100 @@
+#include "Editor/Delays.hpp"
+#include "Utils/File.hpp"
+
+namespace Gate {
+
+  u32 Delays::get(Component::Type type) const {
+    switch (type) {
+      case Component::Type::AndGate:
+      case Component::Type::WordAnd:
+        return andGate;
+      case Component::Type::OrGate:
+      case Component::Type::WordOr:
+        return orGate;
+      case Component::Type::XorGate:
+      case Component::Type::WordXor:
+      case Component::Type::WordAdd:
+        return xorGate;
+      case Component::Type::NotGate: return notGate;
+      case Component::Type::FlipFlop:
+      case Component::Type::Register:
+        return flipFlop;
+      case Component::Type::Ram:
+      case Component::Type::Rom:
+        return memory;
+      case Component::Type::Chip:    return chip;
+      case Component::Type::Switch:
+      case Component::Type::Clock:
+      case Component::Type::Output:
+      case Component::Type::Splitter:
+      case Component::Type::Merger:
+        return wire;
+    }
+    GATE_UNREACHABLE("unknown component type");
+  }
+
+  Option<Delays> Delays::load(const char* filepath) {
+    auto* content = Utils::fileToString(filepath);
+    if (!content) {
+      return None;
+    }
+    const auto node = Serializer::Json::parse(content);
+    free(content);
+    if (!node) {
+      Logger::error("Json: invalid json");
+      return None;
+    }
+    Delays delays;
+    if (!Serializer::Convert<Delays>::decode(*node, delays)) {
+      Logger::error("Delays: invalid delays in '%s'", filepath);
+      return None;
+    }
+    return delays;
+  }
+
+}
+
+namespace Gate::Serializer {
+
+  Node Convert<Delays>::encode(const Delays& value) {
+    auto node = Node::object();
+    node["and"]      = (Node::Integer)value.andGate;
+    node["or"]       = (Node::Integer)value.orGate;
+    node["xor"]      = (Node::Integer)value.xorGate;
+    node["not"]      = (Node::Integer)value.notGate;
+    node["flipflop"] = (Node::Integer)value.flipFlop;
+    node["memory"]   = (Node::Integer)value.memory;
+    node["chip"]     = (Node::Integer)value.chip;
+    node["wire"]     = (Node::Integer)value.wire;
+    return node;
+  }
+
+  bool Convert<Delays>::decode(const Node& node, Delays& value) {
+    if (!node.isObject()) {
+      return false;
+    }
+
+    // Every delay is optional, the missing ones keep their default.
+    auto decodeDelay = [&node](const char* name, u32& delay) {
+      const auto* delayNode = node.get(name);
+      if (!delayNode) {
+        return true;
+      }
+      Node::Integer integer;
+      if (!Convert<Node::Integer>::decode(*delayNode, integer) || integer < 0 || integer > UINT16_MAX) {
+        return false;
+      }
+      delay = (u32)integer;
+      return true;
+    };
+    return decodeDelay("and", value.andGate)
+      && decodeDelay("or", value.orGate)
+      && decodeDelay("xor", value.xorGate)
+      && decodeDelay("not", value.notGate)
+      && decodeDelay("flipflop", value.flipFlop)
+      && decodeDelay("memory", value.memory)
+      && decodeDelay("chip", value.chip)
+      && decodeDelay("wire", value.wire);
+  }
+
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Core/Base.hpp"
+#include "Editor/Components/Component.hpp"
+#include "Serializer/Serializer.hpp"
+
+namespace Gate {
+
+  // Propagation delays of the components in a timing simulation, in time units.
+  struct Delays {
+    u32 andGate = 1;
+    u32 orGate  = 1;
+    u32 xorGate = 1;
+    u32 notGate = 1;
+
+    // From the rising edge of the clock to the output of flip-flops and registers.
+    u32 flipFlop = 1;
+
+    // From the address to the outputs of memories.
+    u32 memory = 1;
+
+    // Memoized sub-chips, the others are timed gate by gate.
+    u32 chip = 1;
+
+    // Connection points with more than one driver and sub-chip boundaries.
+    u32 wire = 0;
+
+    u32 get(Component::Type type) const;
+
+    static Option<Delays> load(const char* filepath);
+  };
+
+}
+
+namespace Gate::Serializer {
+
+  template<>
+  struct Convert<Delays> {
+    static Node encode(const Delays& value);
+    static bool decode(const Node& node, Delays& value);
+  };
+
+}
@@ -41,6 +41,10 @@ namespace Gate {
     config.orGate  = atlas.get(1);
     config.xorGate = atlas.get(2);
     config.notGate = atlas.get(3);
+
+    #ifndef GATE_PLATFORM_WEB
+      mBoard.setBackground(true);
+    #endif
   }
   EditorLayer::~EditorLayer() {
     config.pinMesh = nullptr;
@@ -78,7 +82,20 @@ namespace Gate {
       case Mode::Select: {
         // Selector cursor
         Application::getRenderer2D().drawCenteredQuad(mSelectorPosition, config.selector.size, config.selector.color);
-        const StringView text = " Click on the board to draw a line, or press \"c\" to insert a component!";
+        String text = " Click on the board to draw a line, or press \"c\" to insert a component!";
+        auto& chip = mBoard.getCurrentChip();
+        if (chip.isTiming()) {
+          auto& timing = chip.getTimingEngine();
+          text = " Timing: t = " + std::to_string(timing.getTime()) + (timing.isSettled() ? " (settled)" : "") + ", press \"t\" to stop";
+        } else if (chip.isClockRunning()) {
+          char buffer[160];
+          snprintf(buffer, sizeof(buffer), " Clock: %.3f MHz (%s), cycle %llu, press \"k\" to stop",
+            chip.getClockFrequency() / 1e6,
+            chip.getTargetClockFrequency() > 0.0 ? ("target " + std::to_string((u64)chip.getTargetClockFrequency()) + " Hz").c_str() : "free-running",
+            (unsigned long long)chip.getCycle()
+          );
+          text = buffer;
+        }
         const auto size = 23;
         Application::getRenderer2D().drawText(text, Vec2{size / 2.0f, height - 1.5f * size}, size, Color::BLACK);
       }  break;
@@ -105,12 +122,91 @@ namespace Gate {
       }  break;
     }
   }
+  void EditorLayer::toggleTiming() {
+    auto& chip = mBoard.getCurrentChip();
+    if (chip.isTiming()) {
+      chip.stopTiming();
+      return;
+    }
+
+    Delays delays;
+    #ifndef GATE_PLATFORM_WEB
+      if (auto loaded = Delays::load("delays.json")) {
+        delays = *loaded;
+      }
+    #endif
+    chip.startTiming(delays);
+  }
+  void EditorLayer::toggleClocks() {
+    auto& chip = mBoard.getCurrentChip();
+    if (chip.isClockRunning()) {
+      chip.stopClocks();
+      return;
+    }
+    if (chip.getClockCount() == 0) {
+      Logger::info("The chip has no clock, add one with \"k\" in component mode");
+    }
+    chip.startClocks(CLOCK_FREQUENCIES[mClockFrequencyIndex]);
+  }
+  void EditorLayer::cycleClockFrequency() {
+    mClockFrequencyIndex = (mClockFrequencyIndex + 1) % (u32)std::size(CLOCK_FREQUENCIES);
+    const f64 frequency = CLOCK_FREQUENCIES[mClockFrequencyIndex];
+    if (frequency > 0.0) {
+      Logger::info("Clock frequency: %.0f Hz", frequency);
+    } else {
+      Logger::info("Clock frequency: as fast as possible");
+    }
+    auto& chip = mBoard.getCurrentChip();
+    if (chip.isClockRunning()) {
+      chip.startClocks(frequency);
+    }
+  }
+  void EditorLayer::pushHistory(Chip::State state) {
+    if (mHistory.size() == MAX_HISTORY) {
+      mHistory.erase(mHistory.begin());
+    }
+    mHistory.emplace_back(mBoard.getCurrentChip().getIndex(), std::move(state));
+  }
+  void EditorLayer::rewind() {
+    auto& chip = mBoard.getCurrentChip();
+    if (mHistory.empty() || mHistory.back().first != chip.getIndex()) {
+      return;
+    }
+    // The states from before an edit of the chip can't be restored anymore.
+    if (!chip.restore(mHistory.back().second)) {
+      mHistory.clear();
+      return;
+    }
+    mHistory.pop_back();
+  }
+  void EditorLayer::toggleRecording() {
+    auto& chip = mBoard.getCurrentChip();
+    if (!chip.isRecording()) {
+      Logger::info("Recording the waveform of the chip");
+      chip.startRecording();
+      return;
+    }
+
+    chip.stopRecording();
+    const auto filename = "waveform.vcd";
+    Logger::info("Saving waveform %s", filename);
+    chip.exportWaveform(filename);
+  }
   void EditorLayer::onUpdate3D(Timestep ts) {
     mPerspectiveCameraController.onUpdate(ts);
     Application::getRenderer3D().begin(mPerspectiveCameraController);
     mBoard.render(Application::getRenderer3D());
   }
   void EditorLayer::onUpdate(Timestep ts) {
+    mBoard.sync();
+    mBoard.updateClocks(CLOCK_BUDGET_SECONDS);
+
+    // One time unit per frame, so the propagation can be followed.
+    auto& chip = mBoard.getCurrentChip();
+    if (chip.isTiming()) {
+      chip.advanceTiming(1);
+    }
+
     Application::getRenderer2D().begin(mEditorCameraController.getCamera());
     if (mRenderMode == RenderMode::_2D) {
       onUpdate2D(ts);
@@ -144,6 +240,15 @@ namespace Gate {
             mMode = Mode::Remove;
           } else if (event.getModifier() == KeyModifier::Shift && event.getKey() == Key::N) {
             mBoard.pushNewChip();
+          } else if (event.getKey() == Key::T) {
+            toggleTiming();
+          } else if (event.getModifier() == KeyModifier::Shift && event.getKey() == Key::K) {
+            cycleClockFrequency();
+          } else if (event.getKey() == Key::K) {
+            toggleClocks();
+          } else if (event.getKey() == Key::B) {
+            mBoard.setBackground(!mBoard.isBackground());
+            Logger::info("Background simulation %s", mBoard.isBackground() ? "enabled" : "disabled");
           }
           break;
         case Mode::Remove: {
@@ -156,16 +261,38 @@ namespace Gate {
         case Mode::AddComponent: {
           if (event.getKey() == Key::S) {
             mComponentType = ComponentType::Switch;
+          } else if (event.getKey() == Key::K) {
+            mComponentType = ComponentType::Clock;
           } else if (event.getKey() == Key::F) {
             mComponentType = ComponentType::Output;
           } else if (event.getKey() == Key::N) {
             mComponentType = ComponentType::Not;
+          } else if (event.getModifier() == KeyModifier::Shift && event.getKey() == Key::A) {
+            mComponentType = ComponentType::WordAnd;
+          } else if (event.getModifier() == KeyModifier::Shift && event.getKey() == Key::O) {
+            mComponentType = ComponentType::WordOr;
+          } else if (event.getModifier() == KeyModifier::Shift && event.getKey() == Key::X) {
+            mComponentType = ComponentType::WordXor;
           } else if (event.getKey() == Key::A) {
             mComponentType = ComponentType::And;
           } else if (event.getKey() == Key::O) {
             mComponentType = ComponentType::Or;
           } else if (event.getKey() == Key::X) {
             mComponentType = ComponentType::Xor;
+          } else if (event.getKey() == Key::U) {
+            mComponentType = ComponentType::WordAdd;
+          } else if (event.getKey() == Key::I) {
+            mComponentType = ComponentType::Splitter;
+          } else if (event.getKey() == Key::J) {
+            mComponentType = ComponentType::Merger;
+          } else if (event.getKey() == Key::D) {
+            mComponentType = ComponentType::FlipFlop;
+          } else if (event.getKey() == Key::G) {
+            mComponentType = ComponentType::Register;
+          } else if (event.getKey() == Key::E) {
+            mComponentType = ComponentType::Ram;
+          } else if (event.getKey() == Key::P) {
+            mComponentType = ComponentType::Rom;
           } else if (event.getKey() == Key::C) {
              mComponentType = ComponentType::Chip;
           }
@@ -202,6 +329,10 @@ namespace Gate {
       Application::saveFile(filename, content);
     }
 
+    if (event.getModifier() == KeyModifier::Control && event.getKey() == Key::Z) {
+      rewind();
+    }
+
     if (mMode == Mode::Select && event.getModifier() != KeyModifier::Shift && event.getKey() == Key::N) {
       Application::renameChip();
     }
@@ -235,6 +366,9 @@ namespace Gate {
     }
 
     #ifndef GATE_PLATFORM_WEB
+      if (mMode == Mode::Select && event.getKey() == Key::W) {
+        toggleRecording();
+      }
       if (event.getKey() == Key::Q) {
         Application::get().quit();
       }
@@ -250,10 +384,11 @@ namespace Gate {
           // TODO: Check for collision
           Point mousePosition = Point(gridAlginPosition(mLastMousePosition) / (f32)config.grid.cell.size);
           
+          Chip::State state;
           bool interacted;
           if (mRenderMode == RenderMode::_2D) {
             Logger::warn("x: %u, y: %u", mousePosition.x, mousePosition.y);
-            interacted = mBoard.click(mousePosition);
+            interacted = mBoard.click(mousePosition, &state);
             if (!interacted) {
               mMode = Mode::WireDraw;
               mWireStartPosition = gridAlginPosition(mLastMousePosition);
@@ -262,7 +397,10 @@ namespace Gate {
           } else {
             u32 value = Application::getRenderer3D().readPixel((u32)mLastMousePosition.x, (u32)mLastMousePosition.y);
             Logger::trace("Click(%u, %u): Entity ID: %u", (u32)mLastMousePosition.x, (u32)mLastMousePosition.y, value);
-            interacted = mBoard.click(value);
+            interacted = mBoard.click(value, &state);
+          }
+          if (!state.words.empty()) {
+            pushHistory(std::move(state));
           }
         }  break;
         case Mode::Remove: {
@@ -278,9 +416,6 @@ namespace Gate {
           switch (mBoard.pushWire({ from, to })) {
             case WirePushState::Valid:
               break;
-            case WirePushState::Invalid:
-              GATE_TODO("implement this: wire is invalid");
-              break;
             case WirePushState::Connected:
               connected = true;
               break;
@@ -299,6 +434,9 @@ namespace Gate {
             case ComponentType::Switch: {
               component = new SwitchComponent(position);
             } break;
+            case ComponentType::Clock: {
+              component = new ClockComponent(position);
+            } break;
             case ComponentType::Output: {
               component = new OutputComponent(position);
             } break;
@@ -314,6 +452,36 @@ namespace Gate {
             case ComponentType::Xor: {
               component = new XorComponent(position);
             } break;
+            case ComponentType::FlipFlop: {
+              component = new DFlipFlopComponent(position);
+            } break;
+            case ComponentType::Register: {
+              component = new RegisterComponent(position);
+            } break;
+            case ComponentType::Ram: {
+              component = new RamComponent(position);
+            } break;
+            case ComponentType::Rom: {
+              component = new RomComponent(position);
+            } break;
+            case ComponentType::Splitter: {
+              component = new SplitterComponent(position);
+            } break;
+            case ComponentType::Merger: {
+              component = new MergerComponent(position);
+            } break;
+            case ComponentType::WordAnd: {
+              component = new WordComponent(position, Component::Type::WordAnd);
+            } break;
+            case ComponentType::WordOr: {
+              component = new WordComponent(position, Component::Type::WordOr);
+            } break;
+            case ComponentType::WordXor: {
+              component = new WordComponent(position, Component::Type::WordXor);
+            } break;
+            case ComponentType::WordAdd: {
+              component = new WordComponent(position, Component::Type::WordAdd);
+            } break;
             case ComponentType::Chip: {
               component = new ChipComponent(position, mBoard.getChips()[mChipIndex]);
             } break;
@@ -415,14 +583,17 @@ namespace Gate {
     }
     free(content);
     Board newBoard;
-    if (!Serializer::Convert<Board>::decode(*node, newBoard)) {
+    if (!Serializer::Convert<Board>::decode(*node, newBoard, Utils::parentDirectory(path))) {
       Logger::error("Invalid board in json file");
       return;
     }
     Logger::trace("Replacing board");
+    const bool background = mBoard.isBackground();
     mBoard = newBoard;
+    mBoard.tickAll();
+    mBoard.setBackground(background);
 
-    config.grid.cell.size = mBoard.getCurrentChip().getOptimalCellSize();
+    config.grid.cell.size = mBoard.getCurrentChip().getOptimalCellSize(Application::getWindow().getWidth(), Application::getWindow().getHeight());
   }
   bool EditorLayer::onFileDropEvent(const FileDropEvent& event) {
     const auto& paths = event.getPaths();
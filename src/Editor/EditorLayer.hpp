@@ -13,7 +13,6 @@
 #include "Editor/Wire.hpp"
 
 #include "Editor/Components.hpp"
-#include "Editor/Connection.hpp"
 #include "Editor/Chip.hpp"
 #include "Editor/Board.hpp"
 
@@ -23,6 +22,15 @@ namespace Gate {
 
   class EditorLayer {
   public:
+    // Switch clicks that can be undone with Ctrl+Z.
+    static const constexpr usize MAX_HISTORY = 64;
+
+    // Part of a frame the clocks can run for, when they aren't simulated in the background.
+    static const constexpr f64 CLOCK_BUDGET_SECONDS = 0.008;
+
+    // Frequencies of the base clock that "K" cycles through, 0 runs it as fast as possible.
+    static const constexpr f64 CLOCK_FREQUENCIES[] = { 0.0, 1.0, 10.0, 1000.0, 1000000.0 };
+
     enum class RenderMode {
       _2D,
       _3D,
@@ -41,11 +49,17 @@ namespace Gate {
     Vec2 getGridAlignedMousePosition();
 
     void loadFile(const String& path);
+    void toggleTiming();
+    void toggleRecording();
+    void toggleClocks();
+    void cycleClockFrequency();
 
     Board& getBoard() { return mBoard; }
 
   private:
     void setSelectorPosition(Vec2 position);
+    void pushHistory(Chip::State state);
+    void rewind();
 
     bool onWindowResizeEvent(const WindowResizeEvent& event);
     bool onKeyPressedEvent(const KeyPressedEvent& event);
@@ -64,22 +78,44 @@ namespace Gate {
       };
       enum class ComponentType {
         Switch,
+        Clock,
         Output,
         Not,
         And,
         Or,
         Xor,
+        FlipFlop,
+        Register,
+        Ram,
+        Rom,
+        Splitter,
+        Merger,
+        WordAnd,
+        WordOr,
+        WordXor,
+        WordAdd,
         Chip,
       };
       String componentTypeToString(ComponentType type) {
         switch (type) {
-          case ComponentType::Switch: return "Switch";
-          case ComponentType::Output: return "Output";
-          case ComponentType::Not:    return "NOT Gate";
-          case ComponentType::And:    return "AND Gate";
-          case ComponentType::Or:     return "OR Gate";
-          case ComponentType::Xor:    return "XOR Gate";
-          case ComponentType::Chip:   return mBoard.getChips()[mChipIndex]->getName();
+          case ComponentType::Switch:    return "Switch";
+          case ComponentType::Clock:     return "Clock";
+          case ComponentType::Output:    return "Output";
+          case ComponentType::Not:       return "NOT Gate";
+          case ComponentType::And:       return "AND Gate";
+          case ComponentType::Or:        return "OR Gate";
+          case ComponentType::Xor:       return "XOR Gate";
+          case ComponentType::FlipFlop:  return "D Flip-Flop";
+          case ComponentType::Register:  return "Register";
+          case ComponentType::Ram:       return "RAM";
+          case ComponentType::Rom:       return "ROM";
+          case ComponentType::Splitter:  return "Splitter";
+          case ComponentType::Merger:    return "Merger";
+          case ComponentType::WordAnd:   return "Word AND";
+          case ComponentType::WordOr:    return "Word OR";
+          case ComponentType::WordXor:   return "Word XOR";
+          case ComponentType::WordAdd:   return "Adder";
+          case ComponentType::Chip:      return mBoard.getChips()[mChipIndex]->getName();
         }
         GATE_UNREACHABLE("invalid component type");
       }
@@ -95,6 +131,7 @@ namespace Gate {
     Mode mMode = Mode::Select;
     ComponentType mComponentType = ComponentType::Switch;
     u32 mChipIndex = 0;
+    u32 mClockFrequencyIndex = 0;
 
     // Selector
     Vec2 mSelectorPosition{ 0.0f, 0.0f };
@@ -106,6 +143,9 @@ namespace Gate {
     // Board parts/components
     Board mBoard;
 
+    // Simulation states from before the last clicks, with the index of their chip
+    std::vector<std::pair<u32, Chip::State>> mHistory;
+
     // Testing
     RenderMode mRenderMode = RenderMode::_2D;
     Material::Handle mMaterial;
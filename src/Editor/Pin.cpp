@@ -16,7 +16,7 @@ namespace Gate {
       position.toVec2() * (f32)config.grid.cell.size,
       (isOutput ? config.component.output.size : config.component.input.size) * config.grid.cell.size,
       Color::BLUE,
-      0.2f, // thickness
+      width > 1 ? 0.4f : 0.2f, // thickness
       0.001f
     );
   }
@@ -4,15 +4,22 @@
 #include "Editor/Point.hpp"
 #include "Renderer/Renderer2D.hpp"
 #include "Renderer/Renderer3D.hpp"
+#include "Simulation/Netlist.hpp"
 
 namespace Gate {
 
   struct Pin {
     static const constexpr u32 NULL_CONNECTION = UINT32_MAX;
+    static const constexpr u32 MAX_WIDTH = 64;
 
     Point position;
 
+    // Bits carried by the pin, a bus has consecutive nets starting at net.
+    u32 width = 1;
+
     u32 connectionIndex{NULL_CONNECTION};
+    Simulation::NetId net{Simulation::NULL_NET};
+    // Any bit of a bus.
     bool active = false;
     bool visited = false;
 
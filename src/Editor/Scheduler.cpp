@@ -0,0 +1,82 @@
+#include "Editor/Scheduler.hpp"
+#include "Editor/Components.hpp"
+#include "Core/ThreadPool.hpp"
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace Gate {
+
+  Scheduler::Scheduler(std::vector<Chip::Handle> chips)
+    : mChips{std::move(chips)}
+  {
+    std::unordered_map<const Chip*, u32> indexes;
+    for (u32 i = 0; i < mChips.size(); ++i) {
+      indexes[mChips[i].get()] = i;
+    }
+
+    // Kahn's algorithm, a stage has the chips whose dependencies are all in earlier stages.
+    const u32 chipCount = (u32)mChips.size();
+    std::vector<u32> remaining(chipCount, 0);
+    std::vector<std::vector<u32>> dependents(chipCount);
+    for (u32 i = 0; i < chipCount; ++i) {
+      std::vector<u32> dependencies;
+      for (auto* component : mChips[i]->getComponents()) {
+        if (!component || component->getType() != Component::Type::Chip) {
+          continue;
+        }
+        auto it = indexes.find(((ChipComponent*)component)->getChip().get());
+        if (it != indexes.end() && std::find(dependencies.begin(), dependencies.end(), it->second) == dependencies.end()) {
+          dependencies.push_back(it->second);
+        }
+      }
+      remaining[i] = (u32)dependencies.size();
+      for (auto dependency : dependencies) {
+        dependents[dependency].push_back(i);
+      }
+    }
+
+    std::vector<u32> stage;
+    for (u32 i = 0; i < chipCount; ++i) {
+      if (remaining[i] == 0) {
+        stage.push_back(i);
+      }
+    }
+    u32 scheduled = 0;
+    while (!stage.empty()) {
+      std::vector<u32> next;
+      for (auto chip : stage) {
+        for (auto dependent : dependents[chip]) {
+          if (--remaining[dependent] == 0) {
+            next.push_back(dependent);
+          }
+        }
+      }
+      std::sort(next.begin(), next.end());
+      scheduled += (u32)stage.size();
+      mStages.push_back(std::move(stage));
+      stage = std::move(next);
+    }
+
+    if (scheduled != chipCount) {
+      for (u32 i = 0; i < chipCount; ++i) {
+        if (remaining[i] != 0) {
+          mStages.push_back({i});
+        }
+      }
+    }
+  }
+
+  void Scheduler::run(const Job& job) {
+    for (auto& stage : mStages) {
+      ThreadPool::get().parallelFor((u32)stage.size(), 1, [&](u32 begin, u32 end) {
+        for (u32 i = begin; i < end; ++i) {
+          auto& chip = *mChips[stage[i]];
+          job(stage[i], chip);
+          chip.prepareInstances();
+        }
+      });
+    }
+  }
+
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Core/Base.hpp"
+#include "Editor/Chip.hpp"
+
+#include <functional>
+#include <vector>
+
+namespace Gate {
+
+  // Runs a job on every chip of a board, the chips that don't contain each other concurrently.
+  //
+  // The chips instantiated by the ChipComponents of a chip are its dependencies, they form a DAG
+  // which is split into stages: a chip only depends on chips of earlier stages. The chips of a
+  // stage run on the thread pool and a stage starts once the previous one is done, so when a job
+  // compiles a chip, the chips it inlines are only read (see Chip::prepareInstances()).
+  //
+  // Chips that contain themselves can't be ordered, they run one at a time after the others.
+  class Scheduler {
+  public:
+    using Job = std::function<void(u32 index, Chip& chip)>;
+
+  public:
+    explicit Scheduler(std::vector<Chip::Handle> chips);
+
+    void run(const Job& job);
+
+    // Indexes of the chips of every stage.
+    inline const std::vector<std::vector<u32>>& getStages() const { return mStages; }
+
+  private:
+    std::vector<Chip::Handle> mChips;
+    std::vector<std::vector<u32>> mStages;
+  };
+
+}
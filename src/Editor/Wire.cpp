@@ -5,8 +5,8 @@
 
 namespace Gate {
 
-  void Wire::render(Renderer2D& renderer) {
-    f32 width = config.wire.width * config.grid.cell.size;
+  void Wire::render(Renderer2D& renderer, bool active, bool visited) {
+    f32 width = config.wire.width * config.grid.cell.size * (this->width > 1 ? 2.0f : 1.0f);
 
     Vec2 size = (to.toVec2() - from.toVec2()) * (f32)config.grid.cell.size;
     if (from.x == to.x) {
@@ -50,9 +50,9 @@ namespace Gate {
   }
 
 
-  void Wire::render(Renderer3D& renderer) {
+  void Wire::render(Renderer3D& renderer, bool active) {
     f32 gridCellSize = config.grid.cell.size3d;
-    f32 wireWidth    = gridCellSize * 0.2f;
+    f32 wireWidth    = gridCellSize * (width > 1 ? 0.4f : 0.2f);
 
     // TODO: move to constructor
     Vec3 scale = Vec3{wireWidth};
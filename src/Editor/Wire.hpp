@@ -4,6 +4,7 @@
 #include "Renderer/Renderer2D.hpp"
 #include "Renderer/Renderer3D.hpp"
 #include "Serializer/Serializer.hpp"
+#include "Simulation/Netlist.hpp"
 
 namespace Gate {
   
@@ -13,13 +14,16 @@ namespace Gate {
 
     std::vector<u32> connectionIndexes{};
 
-    bool active = false;
-    bool visited = false;
+    // The net of the connected points, wires are drawn with its value.
+    Simulation::NetId net{Simulation::NULL_NET};
+
+    // Bits of the net, the widest pin it connects to. Buses are drawn thicker.
+    u32 width = 1;
 
     bool free = false;
 
-    void render(Renderer2D& renderer);
-    void render(Renderer3D& renderer);
+    void render(Renderer2D& renderer, bool active = false, bool visited = false);
+    void render(Renderer3D& renderer, bool active = false);
   };
 
 }
@@ -0,0 +1,726 @@
+#include "Core/ThreadPool.hpp"
+#include "Editor/Chip.hpp"
+#include "Editor/Components.hpp"
+#include "Editor/Delays.hpp"
+#include "Editor/Scheduler.hpp"
+#include "Serializer/Serializer.hpp"
+#include "Simulation/Engine.hpp"
+#include "Simulation/Equivalence.hpp"
+#include "Simulation/Fault.hpp"
+#include "Simulation/Stimulus.hpp"
+#include "Simulation/Timing.hpp"
+#include "Simulation/Waveform.hpp"
+#include "Utils/File.hpp"
+
+#include <chrono>
+#include <cstring>
+
+// Runs input vectors through a chip of a board, without a window.
+//
+// Every line of the vectors has a '0' or '1' for each switch of the chip (in the order
+// they were placed) followed by each clock, whitespace and '_' are ignored and '#' starts a
+// comment. A line with the values of the output components is written for every vector.
+//
+// With --timing the vectors are applied one after the other to the event driven simulator,
+// and the time the chip took to settle is appended to every line.
+//
+// With --vcd the inputs and outputs of the last vectors are written as a waveform, one time unit
+// per vector (or the settle times with --timing).
+//
+// With --faults every stuck-at fault of the pins of the chip is simulated against all the vectors,
+// and a line is written for every fault: its pin, the stuck value and the first vector that
+// detects it.
+//
+// With --stimulus no vectors are read, random or Gray code vectors are generated until the toggle
+// coverage of the chip saturates (of every chip with --all-chips, the chips that don't contain each
+// other run concurrently). It fails when an output never toggled, so a board can be smoke tested.
+//
+// With --equivalent the chip is compared with another chip (of another board with --against),
+// the exit code is 0 if they are equivalent, 1 with a counterexample and 2 if it couldn't be proved.
+//
+// With --clock the clocks of the chip run for a number of cycles as fast as possible, from all the
+// switches off, and the outputs after the last cycle are written. With --vcd every half cycle is
+// a sample of the waveform.
+
+namespace {
+
+  using namespace Gate;
+
+  // Vectors simulated at once, a few full passes of the engine.
+  static const constexpr usize BATCH_VECTORS = 64 * Simulation::Engine::MAX_STRIDE * 4;
+
+  // Time units after which a vector that hasn't settled is considered to oscillate.
+  static const constexpr Simulation::Time SETTLE_LIMIT = 1 << 20;
+
+  // Part of the run time that recording is expected to stay under.
+  static const constexpr f64 RECORDING_BUDGET = 0.1;
+
+  struct Options {
+    const char* boardPath   = nullptr;
+    const char* vectorsPath = nullptr;
+    const char* exportPath  = nullptr;
+    const char* nativePath  = nullptr;
+    const char* delaysPath  = nullptr;
+    const char* vcdPath     = nullptr;
+    const char* againstPath = nullptr;
+    i64 chipIndex = -1;
+    i64 equivalentIndex = -1;
+    u64 clockCycles = 0;
+    bool quiet = false;
+    bool faults = false;
+    bool stimulus = false;
+    bool allChips = false;
+    Simulation::StimulusGenerator::Options stimulusOptions;
+    Simulation::EquivalenceChecker::Options equivalenceOptions;
+  };
+
+  void usage(const char* program) {
+    fprintf(stderr, "usage: %s <board.json> [vectors] [--chip <index>] [--quiet] [--export <file.cpp>] [--native <library>] [--timing <delays.json>] [--vcd <file.vcd>] [--faults]\n", program);
+    fprintf(stderr, "       %s <board.json> --stimulus <random|gray> [--all-chips] [--max-vectors <count>] [--seed <seed>]\n", program);
+    fprintf(stderr, "       %s <board.json> --equivalent <index> [--chip <index>] [--against <board.json>] [--seed <seed>]\n", program);
+    fprintf(stderr, "       %s <board.json> --clock <cycles> [--chip <index>] [--vcd <file.vcd>] [--quiet]\n", program);
+    fprintf(stderr, "  vectors          file with one input vector per line (default: stdin)\n");
+    fprintf(stderr, "  --chip <index>   chip of the board to simulate (default: the last one)\n");
+    fprintf(stderr, "  --quiet          don't write the outputs, only the throughput\n");
+    fprintf(stderr, "  --export <file>  write the chip as C++ and exit, compile it with e.g. 'c++ -O2 -shared -fPIC'\n");
+    fprintf(stderr, "  --native <file>  simulate with a library compiled from an exported chip\n");
+    fprintf(stderr, "  --timing <file>  simulate with the gate delays of the file, and write the settle times\n");
+    fprintf(stderr, "  --faults         simulate the stuck-at faults of the chip, and write which vectors detect them\n");
+    fprintf(stderr, "  --stimulus <m>   generate vectors until the toggle coverage saturates\n");
+    fprintf(stderr, "  --all-chips      run the stimulus on every chip of the board\n");
+    fprintf(stderr, "  --equivalent <i> check that the chip computes the same outputs as chip i\n");
+    fprintf(stderr, "  --against <file> board of the chip to compare with (default: the same board)\n");
+    fprintf(stderr, "  --clock <cycles> run the clocks of the chip, and write the outputs after the last cycle\n");
+    fprintf(stderr, "  --vcd <file>     write the waveform of the last %u vectors (or half cycles)\n", Simulation::Waveform::DEFAULT_CAPACITY);
+  }
+
+  bool parseOptions(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+      if (strcmp(argv[i], "--quiet") == 0) {
+        options.quiet = true;
+      } else if (strcmp(argv[i], "--chip") == 0 && i + 1 < argc) {
+        options.chipIndex = strtoll(argv[++i], nullptr, 10);
+      } else if (strcmp(argv[i], "--export") == 0 && i + 1 < argc) {
+        options.exportPath = argv[++i];
+      } else if (strcmp(argv[i], "--native") == 0 && i + 1 < argc) {
+        options.nativePath = argv[++i];
+      } else if (strcmp(argv[i], "--timing") == 0 && i + 1 < argc) {
+        options.delaysPath = argv[++i];
+      } else if (strcmp(argv[i], "--faults") == 0) {
+        options.faults = true;
+      } else if (strcmp(argv[i], "--stimulus") == 0 && i + 1 < argc) {
+        options.stimulus = true;
+        i++;
+        if (strcmp(argv[i], "random") == 0) {
+          options.stimulusOptions.mode = Simulation::StimulusGenerator::Mode::Random;
+        } else if (strcmp(argv[i], "gray") == 0) {
+          options.stimulusOptions.mode = Simulation::StimulusGenerator::Mode::Gray;
+        } else {
+          return false;
+        }
+      } else if (strcmp(argv[i], "--all-chips") == 0) {
+        options.allChips = true;
+      } else if (strcmp(argv[i], "--max-vectors") == 0 && i + 1 < argc) {
+        options.stimulusOptions.maxVectors = strtoull(argv[++i], nullptr, 10);
+      } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+        options.stimulusOptions.seed = strtoull(argv[++i], nullptr, 10);
+        options.equivalenceOptions.seed = options.stimulusOptions.seed;
+      } else if (strcmp(argv[i], "--equivalent") == 0 && i + 1 < argc) {
+        options.equivalentIndex = strtoll(argv[++i], nullptr, 10);
+      } else if (strcmp(argv[i], "--against") == 0 && i + 1 < argc) {
+        options.againstPath = argv[++i];
+      } else if (strcmp(argv[i], "--clock") == 0 && i + 1 < argc) {
+        options.clockCycles = strtoull(argv[++i], nullptr, 10);
+      } else if (strcmp(argv[i], "--vcd") == 0 && i + 1 < argc) {
+        options.vcdPath = argv[++i];
+      } else if (argv[i][0] == '-' && argv[i][1] != '\0') {
+        return false;
+      } else if (!options.boardPath) {
+        options.boardPath = argv[i];
+      } else if (!options.vectorsPath) {
+        options.vectorsPath = argv[i];
+      } else {
+        return false;
+      }
+    }
+    return options.boardPath != nullptr;
+  }
+
+  bool loadChips(const char* path, std::vector<Chip::Handle>& chips) {
+    using namespace Serializer;
+
+    char* content = Utils::fileToString(path);
+    if (!content) {
+      return false;
+    }
+    auto node = Json::parse(content);
+    free(content);
+    if (!node || !node->isObject()) {
+      fprintf(stderr, "error: '%s' is not a valid json file\n", path);
+      return false;
+    }
+
+    auto* chipsNode = node->get("chips");
+    if (!chipsNode || !chipsNode->isArray()) {
+      fprintf(stderr, "error: '%s' is not a board\n", path);
+      return false;
+    }
+    const auto directory = Utils::parentDirectory(path);
+    for (auto& chipNode : *chipsNode->asArray()) {
+      auto chip = Chip::create((u32)chips.size());
+      if (!Convert<Chip>::decode(chipNode, *chip, chips, directory)) {
+        fprintf(stderr, "error: invalid chip %zu in '%s'\n", chips.size(), path);
+        return false;
+      }
+      chips.push_back(std::move(chip));
+    }
+    return true;
+  }
+
+  bool readLine(FILE* file, String& line) {
+    line.clear();
+    int c;
+    while ((c = fgetc(file)) != EOF && c != '\n') {
+      line.push_back((char)c);
+    }
+    return c != EOF || !line.empty();
+  }
+
+  void setWaveformSignals(Simulation::Waveform& waveform, usize inputCount, usize outputCount) {
+    std::vector<String> names;
+    for (usize i = 0; i < inputCount; ++i) {
+      names.push_back("in" + std::to_string(i));
+    }
+    for (usize i = 0; i < outputCount; ++i) {
+      names.push_back("out" + std::to_string(i));
+    }
+    waveform.setSignals(std::move(names));
+  }
+
+  bool writeWaveform(const Simulation::Waveform& waveform, const char* path, const Chip& chip, f64 recordingSeconds, f64 seconds) {
+    if (!waveform.exportVcd(path, chip.getName())) {
+      return false;
+    }
+    fprintf(stderr, "gate-sim: recorded %llu samples (%llu overwritten) in %.3f ms\n",
+      (unsigned long long)waveform.getRecordedCount(),
+      (unsigned long long)waveform.getOverwrittenCount(),
+      recordingSeconds * 1000.0
+    );
+    if (recordingSeconds > RECORDING_BUDGET * seconds) {
+      fprintf(stderr, "warning: recording took %.0f%% of the run time, the budget is %.0f%%\n",
+        100.0 * recordingSeconds / seconds,
+        100.0 * RECORDING_BUDGET
+      );
+    }
+    return true;
+  }
+
+  // Reads the next vector into bits (2 marks an invalid character), skipping empty lines.
+  bool readVector(FILE* file, std::vector<u8>& bits, usize& lineNumber) {
+    String line;
+    while (readLine(file, line)) {
+      lineNumber++;
+      bits.clear();
+      for (char c : line) {
+        if (c == '#') {
+          break;
+        } else if (c == '0' || c == '1') {
+          bits.push_back(u8(c - '0'));
+        } else if (c != ' ' && c != '\t' && c != '\r' && c != '_') {
+          bits.push_back(2);
+        }
+      }
+      if (!bits.empty()) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  struct StimulusResult {
+    Simulation::StimulusGenerator::Report report;
+    f64 seconds = 0.0;
+  };
+
+  StimulusResult runStimulus(Chip& chip, const Options& options) {
+    using Clock = std::chrono::steady_clock;
+
+    StimulusResult result;
+    auto start = Clock::now();
+    result.report = chip.runStimulus(options.stimulusOptions);
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return result;
+  }
+
+  // Returns false if an output of the chip never toggled.
+  bool printStimulus(usize index, const Chip& chip, const StimulusResult& result) {
+    auto& report = result.report;
+    const f64 seconds = result.seconds;
+    auto[inputComponents, outputComponents] = chip.getPinComponents();
+    const char* reason = report.toggledCount == report.netCount ? "complete"
+      : report.exhausted ? "exhausted"
+      : report.saturated ? "saturated"
+      : "limit";
+    printf("chip %zu '%s': %zu inputs, %zu outputs, %llu vectors in %.3f ms (%.0f vectors/s), %u/%u nets toggled (%.1f%%, %s)\n",
+      index,
+      chip.getName().c_str(),
+      inputComponents.size(),
+      outputComponents.size(),
+      (unsigned long long)report.vectorCount,
+      seconds * 1000.0,
+      seconds > 0.0 ? report.vectorCount / seconds : 0.0,
+      report.toggledCount,
+      report.netCount,
+      report.getCoverage() * 100.0,
+      reason
+    );
+
+    bool toggled = true;
+    for (usize i = 0; i < outputComponents.size(); ++i) {
+      auto net = outputComponents[i]->getInputPins()[0].net;
+      if (net >= report.toggled.size() || !report.toggled[net]) {
+        printf("  output %zu never toggled\n", i);
+        toggled = false;
+      }
+    }
+    return toggled;
+  }
+
+  int runEquivalence(Chip& chip, Chip& other, const Options& options) {
+    using Clock = std::chrono::steady_clock;
+    using namespace Simulation;
+
+    auto outputComponents = chip.getPinComponents().second;
+    auto otherOutputComponents = other.getPinComponents().second;
+    if (chip.getInputCount() != other.getInputCount() || outputComponents.size() != otherOutputComponents.size()) {
+      fprintf(stderr, "error: the chips don't have the same pins, %u inputs and %zu outputs against %u inputs and %zu outputs\n",
+        chip.getInputCount(),
+        outputComponents.size(),
+        other.getInputCount(),
+        otherOutputComponents.size()
+      );
+      return 1;
+    }
+
+    auto start = Clock::now();
+    auto report = chip.checkEquivalence(other, options.equivalenceOptions);
+    auto seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    String text;
+    switch (report.result) {
+      case EquivalenceChecker::Result::Equivalent:
+        text = "equivalent";
+        break;
+      case EquivalenceChecker::Result::Different:
+        text = "different: ";
+        for (auto value : report.counterexample) {
+          text.push_back(value ? '1' : '0');
+        }
+        text += " gives ";
+        for (auto value : report.outputsA) {
+          text.push_back(value ? '1' : '0');
+        }
+        text += " and ";
+        for (auto value : report.outputsB) {
+          text.push_back(value ? '1' : '0');
+        }
+        break;
+      case EquivalenceChecker::Result::Unknown:
+        text = report.method == EquivalenceChecker::Method::Sat ? "unknown: the conflict limit was reached" : "unknown: feedback loops can only be screened";
+        break;
+    }
+    printf("%s\n", text.c_str());
+
+    switch (report.method) {
+      case EquivalenceChecker::Method::Exhaustive:
+      case EquivalenceChecker::Method::Random:
+        fprintf(stderr, "gate-sim: %llu %s vectors in %.3f ms\n",
+          (unsigned long long)report.vectorCount,
+          report.method == EquivalenceChecker::Method::Exhaustive ? "exhaustive" : "random",
+          seconds * 1000.0
+        );
+        break;
+      case EquivalenceChecker::Method::Sat:
+        fprintf(stderr, "gate-sim: %llu random vectors, then %u variables, %u clauses and %llu conflicts in %.3f ms\n",
+          (unsigned long long)report.vectorCount,
+          report.variableCount,
+          report.clauseCount,
+          (unsigned long long)report.conflictCount,
+          seconds * 1000.0
+        );
+        break;
+    }
+    return report.result == EquivalenceChecker::Result::Equivalent ? 0 : report.result == EquivalenceChecker::Result::Different ? 1 : 2;
+  }
+
+  int runFaults(Chip& chip, FILE* file, const Options& options) {
+    using Clock = std::chrono::steady_clock;
+
+    const usize inputCount = chip.getInputCount();
+
+    // All the vectors are needed at once, packed 64 per word of every input.
+    std::vector<u8> bits;
+    std::vector<u64> inputs;
+    usize line = 0;
+    usize vectorCount = 0;
+    while (readVector(file, bits, line)) {
+      if (bits.size() != inputCount || std::find(bits.begin(), bits.end(), u8(2)) != bits.end()) {
+        fprintf(stderr, "error: line %zu: expected %zu binary inputs\n", line, inputCount);
+        return 1;
+      }
+      if (vectorCount % 64 == 0) {
+        inputs.resize(inputs.size() + inputCount, 0);
+      }
+      for (usize i = 0; i < inputCount; ++i) {
+        inputs[(vectorCount / 64) * inputCount + i] |= u64(bits[i]) << (vectorCount % 64);
+      }
+      vectorCount++;
+    }
+
+    auto start = Clock::now();
+    std::vector<String> pinNames;
+    auto report = chip.simulateFaults(Slice<const u64>(inputs.data(), inputs.size()), vectorCount, &pinNames);
+    auto seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    if (!options.quiet) {
+      String text;
+      for (usize i = 0; i < report.faults.size(); ++i) {
+        auto& fault = report.faults[i];
+        text.clear();
+        text += pinNames[i];
+        text += fault.value ? " 1 " : " 0 ";
+        text += report.detectedBy[i] == Simulation::FaultSimulator::NOT_DETECTED ? String("-") : std::to_string(report.detectedBy[i]);
+        text += '\n';
+        fwrite(text.data(), 1, text.size(), stdout);
+      }
+    }
+
+    fprintf(stderr, "gate-sim: %zu vectors detect %u of %zu faults (%.1f%% coverage) in %.3f ms\n",
+      vectorCount,
+      report.detectedCount,
+      report.faults.size(),
+      report.getCoverage() * 100.0,
+      seconds * 1000.0
+    );
+    return 0;
+  }
+
+  int runClock(Chip& chip, const Options& options) {
+    using Clock = std::chrono::steady_clock;
+
+    chip.tick();
+    if (options.vcdPath) {
+      chip.startRecording();
+    }
+    auto start = Clock::now();
+    chip.advanceClocks(options.clockCycles);
+    auto seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    if (!options.quiet) {
+      String text;
+      for (auto* output : chip.getPinComponents().second) {
+        text.push_back(output->getInputPins()[OutputComponent::INPUT_INDEX].active ? '1' : '0');
+      }
+      text += '\n';
+      fwrite(text.data(), 1, text.size(), stdout);
+    }
+
+    fprintf(stderr, "gate-sim: %llu cycles of %u clocks in %.3f ms (%.3f MHz)\n",
+      (unsigned long long)options.clockCycles,
+      chip.getClockCount(),
+      seconds * 1000.0,
+      seconds > 0.0 ? options.clockCycles / seconds / 1e6 : 0.0
+    );
+
+    if (options.vcdPath) {
+      if (!chip.exportWaveform(options.vcdPath)) {
+        return 1;
+      }
+      const auto& waveform = chip.getWaveform();
+      fprintf(stderr, "gate-sim: recorded %llu samples (%llu overwritten)\n",
+        (unsigned long long)waveform.getRecordedCount(),
+        (unsigned long long)waveform.getOverwrittenCount()
+      );
+    }
+    return chip.getClockCount() != 0 ? 0 : 1;
+  }
+
+  int runTiming(Chip& chip, const Delays& delays, FILE* file, const Options& options) {
+    using Clock = std::chrono::steady_clock;
+
+    chip.startTiming(delays);
+    auto& timing = chip.getTimingEngine();
+    auto& netlist = timing.getNetlist();
+    const usize inputCount  = netlist.getInputs().size();
+    const usize outputCount = netlist.getOutputs().size();
+
+    Simulation::Waveform waveform;
+    Clock::duration recordingTime{0};
+    if (options.vcdPath) {
+      setWaveformSignals(waveform, inputCount, outputCount);
+    }
+
+    std::vector<u8> bits;
+    String text;
+    usize line = 0;
+    u64 vectorCount = 0;
+    Simulation::Time maxSettleTime = 0;
+    auto start = Clock::now();
+
+    // Power on.
+    if (!timing.settle(SETTLE_LIMIT)) {
+      fprintf(stderr, "error: the chip doesn't settle after power on\n");
+      return 1;
+    }
+    while (readVector(file, bits, line)) {
+      if (bits.size() != inputCount || std::find(bits.begin(), bits.end(), u8(2)) != bits.end()) {
+        fprintf(stderr, "error: line %zu: expected %zu binary inputs\n", line, inputCount);
+        return 1;
+      }
+
+      const Simulation::Time vectorStart = timing.getTime();
+      for (usize i = 0; i < inputCount; ++i) {
+        timing.setInput((u32)i, bits[i]);
+      }
+      if (!timing.settle(SETTLE_LIMIT)) {
+        fprintf(stderr, "error: line %zu: the chip doesn't settle after %llu time units\n", line, (unsigned long long)SETTLE_LIMIT);
+        return 1;
+      }
+      Simulation::Time settleTime = 0;
+      for (auto net : timing.getChangedNets()) {
+        settleTime = std::max(settleTime, timing.getChangeTime(net) - vectorStart);
+      }
+      maxSettleTime = std::max(maxSettleTime, settleTime);
+      vectorCount++;
+
+      if (options.vcdPath) {
+        auto recordingStart = Clock::now();
+        waveform.record(vectorStart + settleTime, [&](u32 i) {
+          return i < inputCount ? bits[i] != 0 : timing.getValue(netlist.getOutputs()[i - inputCount]);
+        });
+        recordingTime += Clock::now() - recordingStart;
+      }
+      if (options.quiet) {
+        continue;
+      }
+      text.clear();
+      for (auto net : netlist.getOutputs()) {
+        text.push_back(timing.getValue(net) ? '1' : '0');
+      }
+      text += ' ';
+      text += std::to_string(settleTime);
+      text += '\n';
+      fwrite(text.data(), 1, text.size(), stdout);
+    }
+
+    auto seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    fprintf(stderr, "gate-sim: %llu vectors in %.3f ms, %llu events (%.0f events/s), settled in at most %llu time units\n",
+      (unsigned long long)vectorCount,
+      seconds * 1000.0,
+      (unsigned long long)timing.getEventCount(),
+      seconds > 0.0 ? timing.getEventCount() / seconds : 0.0,
+      (unsigned long long)maxSettleTime
+    );
+    if (options.vcdPath && !writeWaveform(waveform, options.vcdPath, chip, std::chrono::duration<double>(recordingTime).count(), seconds)) {
+      return 1;
+    }
+    return 0;
+  }
+
+}
+
+int main(int argc, char* argv[]) {
+  using namespace Gate;
+  using Clock = std::chrono::steady_clock;
+
+  Options options;
+  if (!parseOptions(argc, argv, options)) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  std::vector<Chip::Handle> chips;
+  if (!loadChips(options.boardPath, chips)) {
+    return 1;
+  }
+  if (chips.empty()) {
+    fprintf(stderr, "error: '%s' has no chips\n", options.boardPath);
+    return 1;
+  }
+  if (options.chipIndex < 0) {
+    options.chipIndex = (i64)chips.size() - 1;
+  }
+  if ((usize)options.chipIndex >= chips.size()) {
+    fprintf(stderr, "error: there is no chip %lld, the board has %zu\n", (long long)options.chipIndex, chips.size());
+    return 1;
+  }
+  auto& chip = *chips[options.chipIndex];
+
+  if (options.stimulus) {
+    if (!options.allChips) {
+      return printStimulus((usize)options.chipIndex, chip, runStimulus(chip, options)) ? 0 : 1;
+    }
+
+    std::vector<StimulusResult> results(chips.size());
+    auto start = Clock::now();
+    Scheduler scheduler(chips);
+    scheduler.run([&](u32 index, Chip& chip) {
+      results[index] = runStimulus(chip, options);
+    });
+    auto seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    bool passed = true;
+    for (usize i = 0; i < chips.size(); ++i) {
+      passed &= printStimulus(i, *chips[i], results[i]);
+    }
+    fprintf(stderr, "gate-sim: %zu chips in %zu stages in %.3f ms on %u threads\n",
+      chips.size(),
+      scheduler.getStages().size(),
+      seconds * 1000.0,
+      ThreadPool::get().getThreadCount()
+    );
+    return passed ? 0 : 1;
+  }
+
+  if (options.equivalentIndex >= 0) {
+    std::vector<Chip::Handle> otherChips;
+    if (options.againstPath && !loadChips(options.againstPath, otherChips)) {
+      return 1;
+    }
+    auto& candidates = options.againstPath ? otherChips : chips;
+    if ((usize)options.equivalentIndex >= candidates.size()) {
+      fprintf(stderr, "error: there is no chip %lld to compare with, the board has %zu\n", (long long)options.equivalentIndex, candidates.size());
+      return 1;
+    }
+    return runEquivalence(chip, *candidates[options.equivalentIndex], options);
+  }
+
+  if (options.exportPath) {
+    return chip.exportNative(options.exportPath) ? 0 : 1;
+  }
+  if (options.nativePath && !chip.loadNative(options.nativePath)) {
+    return 1;
+  }
+
+  if (options.clockCycles > 0) {
+    return runClock(chip, options);
+  }
+
+  FILE* file = stdin;
+  if (options.vectorsPath) {
+    file = fopen(options.vectorsPath, "r");
+    if (!file) {
+      fprintf(stderr, "error: couldn't open '%s': %s\n", options.vectorsPath, strerror(errno));
+      return 1;
+    }
+  }
+
+  if (options.faults) {
+    int result = runFaults(chip, file, options);
+    if (file != stdin) {
+      fclose(file);
+    }
+    return result;
+  }
+
+  if (options.delaysPath) {
+    auto delays = Delays::load(options.delaysPath);
+    if (!delays) {
+      fprintf(stderr, "error: couldn't load the delays from '%s'\n", options.delaysPath);
+      return 1;
+    }
+    int result = runTiming(chip, *delays, file, options);
+    if (file != stdin) {
+      fclose(file);
+    }
+    return result;
+  }
+
+  auto outputComponents = chip.getPinComponents().second;
+  const usize inputCount  = chip.getInputCount();
+  const usize outputCount = outputComponents.size();
+
+  Simulation::Waveform waveform;
+  Clock::duration recordingTime{0};
+  std::vector<u64> signalWords(inputCount + outputCount);
+  if (options.vcdPath) {
+    setWaveformSignals(waveform, inputCount, outputCount);
+  }
+
+  std::vector<u8> bits;
+  std::vector<u64> inputs;
+  std::vector<char> text;
+  usize line = 0;
+  u64 vectorCount = 0;
+  Clock::duration simulationTime{0};
+  auto start = Clock::now();
+
+  bool done = false;
+  while (!done) {
+    // Pack the vectors of a batch, 64 per word of every input.
+    inputs.assign(BATCH_VECTORS / 64 * inputCount, 0);
+    usize count = 0;
+    for (; count < BATCH_VECTORS; ++count) {
+      if (!readVector(file, bits, line)) {
+        done = true;
+        break;
+      }
+      if (bits.size() != inputCount || std::find(bits.begin(), bits.end(), u8(2)) != bits.end()) {
+        fprintf(stderr, "error: line %zu: expected %zu binary inputs\n", line, inputCount);
+        return 1;
+      }
+      for (usize i = 0; i < inputCount; ++i) {
+        inputs[(count / 64) * inputCount + i] |= u64(bits[i]) << (count % 64);
+      }
+    }
+    if (count == 0) {
+      break;
+    }
+
+    const usize batchCount = (count + 63) / 64;
+    auto simulationStart = Clock::now();
+    auto outputs = chip.simulateVectors(Slice<const u64>(inputs.data(), batchCount * inputCount));
+    simulationTime += Clock::now() - simulationStart;
+
+    if (options.vcdPath) {
+      auto recordingStart = Clock::now();
+      for (usize batch = 0; batch < batchCount; ++batch) {
+        std::copy_n(inputs.data() + batch * inputCount, inputCount, signalWords.begin());
+        std::copy_n(outputs.data() + batch * outputCount, outputCount, signalWords.begin() + inputCount);
+        waveform.recordLanes(vectorCount + batch * 64, (u32)std::min<usize>(64, count - batch * 64), signalWords.data());
+      }
+      recordingTime += Clock::now() - recordingStart;
+    }
+    vectorCount += count;
+
+    if (options.quiet) {
+      continue;
+    }
+    text.resize(count * (outputCount + 1));
+    char* cursor = text.data();
+    for (usize vector = 0; vector < count; ++vector) {
+      for (usize i = 0; i < outputCount; ++i) {
+        *cursor++ = (outputs[(vector / 64) * outputCount + i] >> (vector % 64)) & 1 ? '1' : '0';
+      }
+      *cursor++ = '\n';
+    }
+    fwrite(text.data(), 1, text.size(), stdout);
+  }
+
+  auto seconds = std::chrono::duration<double>(Clock::now() - start).count();
+  auto simulationSeconds = std::chrono::duration<double>(simulationTime).count();
+  if (file != stdin) {
+    fclose(file);
+  }
+
+  fprintf(stderr, "gate-sim: %llu vectors in %.3f ms, %.0f vectors/s (%.0f vectors/s with i/o)\n",
+    (unsigned long long)vectorCount,
+    simulationSeconds * 1000.0,
+    simulationSeconds > 0.0 ? vectorCount / simulationSeconds : 0.0,
+    seconds > 0.0 ? vectorCount / seconds : 0.0
+  );
+  if (options.vcdPath && !writeWaveform(waveform, options.vcdPath, chip, std::chrono::duration<double>(recordingTime).count(), seconds)) {
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,15 @@
+#include "Renderer/Renderer2D.hpp"
+#include "Renderer/Renderer3D.hpp"
+
+// The headless simulator links the editor without a graphics context,
+// so the draw calls of the chips and components do nothing.
+namespace Gate {
+
+  void Renderer2D::drawQuad(const Vec2&, const Vec2&, const Vec4&, Effect) {}
+  void Renderer2D::drawCenteredQuad(const Vec2&, const Vec2&, const Vec4&, Effect) {}
+  void Renderer2D::drawCenteredQuad(const Vec2&, const Vec2&, const SubTexture&, const Vec4&, Effect) {}
+  void Renderer2D::drawCenteredCircle(const Vec2&, float, const Vec4&, float, float) {}
+
+  void Renderer3D::submit(const Mesh::Handle&, const Material::Handle&, const Mat4&, u32) {}
+
+}
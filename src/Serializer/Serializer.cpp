@@ -365,6 +365,69 @@ namespace Gate::Serializer {
     return node;
   }
 
+  namespace {
+    static const constexpr char BASE64_DIGITS[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    i32 base64Value(char c) {
+      if (c >= 'A' && c <= 'Z') return c - 'A';
+      if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+      if (c >= '0' && c <= '9') return c - '0' + 52;
+      if (c == '+') return 62;
+      if (c == '/') return 63;
+      return -1;
+    }
+  }
+
+  Node Convert<std::vector<u8>>::encode(const std::vector<u8>& value) {
+    String string;
+    string.reserve((value.size() + 2) / 3 * 4);
+    for (usize i = 0; i < value.size(); i += 3) {
+      const usize count = std::min<usize>(3, value.size() - i);
+      u32 bits = u32(value[i]) << 16;
+      if (count > 1) bits |= u32(value[i + 1]) << 8;
+      if (count > 2) bits |= u32(value[i + 2]);
+      for (usize j = 0; j < 4; ++j) {
+        string.push_back(j <= count ? BASE64_DIGITS[(bits >> (18 - j * 6)) & 0x3F] : '=');
+      }
+    }
+    return string;
+  }
+
+  bool Convert<std::vector<u8>>::decode(const Node& node, std::vector<u8>& value) {
+    if (!node.isString()) {
+      return false;
+    }
+    auto& string = *node.asString();
+    if (string.size() % 4 != 0) {
+      return false;
+    }
+    value.clear();
+    value.reserve(string.size() / 4 * 3);
+    for (usize i = 0; i < string.size(); i += 4) {
+      u32 bits = 0;
+      usize count = 0;
+      for (usize j = 0; j < 4; ++j) {
+        const char c = string[i + j];
+        if (c == '=' && i + 4 == string.size() && j >= 2) {
+          continue;
+        }
+        const i32 digit = base64Value(c);
+        if (digit < 0 || count != j) {
+          return false;
+        }
+        bits |= u32(digit) << (18 - j * 6);
+        count++;
+      }
+      if (count < 2) {
+        return false;
+      }
+      for (usize j = 0; j + 1 < count; ++j) {
+        value.push_back(u8(bits >> (16 - j * 8)));
+      }
+    }
+    return true;
+  }
+
   Option<Node> Json::parse(StringView source) {
     auto parser = Json(source);
     auto result = parser.parseNode();
@@ -309,6 +309,13 @@ namespace Gate::Serializer {
     }
   };
 
+  // Binary data is stored as a base64 string, rather than as an array with a number per byte.
+  template<>
+  struct Convert<std::vector<u8>> {
+    static Node encode(const std::vector<u8>& value);
+    static bool decode(const Node& node, std::vector<u8>& value);
+  };
+
   template<typename V>
   struct Convert<std::unordered_map<String, V>> {
     static Node encode(const std::unordered_map<String, V>& value) {
@@ -0,0 +1,163 @@
+#include "Simulation/Background.hpp"
+
+#include <algorithm>
+
+namespace Gate::Simulation {
+
+  BackgroundEngine::BackgroundEngine() {
+#ifndef GATE_PLATFORM_WEB
+    mThread = std::thread([this] { work(); });
+#endif
+  }
+
+  BackgroundEngine::~BackgroundEngine() {
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mStop = true;
+    }
+    mCondition.notify_one();
+    if (mThread.joinable()) {
+      mThread.join();
+    }
+  }
+
+  void BackgroundEngine::load(const Netlist& netlist, u64 generation, std::vector<u8> inputs, const ClockDriver& clocks, std::vector<u64> state) {
+    Command command{};
+    command.type = CommandType::Load;
+    command.netlist = std::make_shared<const Netlist>(netlist);
+    command.generation = generation;
+    command.inputs = std::move(inputs);
+    command.state = std::move(state);
+    command.firstClock = clocks.getFirstInput();
+    command.periods = clocks.getPeriods();
+    command.halfCycle = clocks.getHalfCycle();
+    push(std::move(command));
+  }
+
+  void BackgroundEngine::setInput(u32 index, bool value) {
+    Command command{};
+    command.type = CommandType::SetInput;
+    command.index = index;
+    command.value = value;
+    push(std::move(command));
+  }
+
+  void BackgroundEngine::run(f64 frequency) {
+    Command command{};
+    command.type = CommandType::Run;
+    command.frequency = frequency;
+    push(std::move(command));
+  }
+
+  void BackgroundEngine::stop() {
+    Command command{};
+    command.type = CommandType::Stop;
+    push(std::move(command));
+  }
+
+  const BackgroundEngine::Frame* BackgroundEngine::acquire() {
+#ifdef GATE_PLATFORM_WEB
+    // Half of the frame is left to the rendering.
+    if (mClock.isRunning()) {
+      step(FRAME_SECONDS / 2.0);
+      publish();
+    }
+#endif
+    return mFrames.acquire() ? &mFrames.getReadBuffer() : nullptr;
+  }
+
+  void BackgroundEngine::push(Command command) {
+#ifdef GATE_PLATFORM_WEB
+    apply(command);
+    publish();
+#else
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mCommands.push_back(std::move(command));
+    }
+    mCondition.notify_one();
+#endif
+  }
+
+  void BackgroundEngine::work() {
+    std::vector<Command> commands;
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(mMutex);
+        auto ready = [&] { return mStop || !mCommands.empty(); };
+        if (mClock.isRunning()) {
+          // Sleeps until the next half cycle is due, the commands are applied in between.
+          mCondition.wait_for(lock, std::chrono::duration<f64>(std::min(mClock.getIdleSeconds(), FRAME_SECONDS)), ready);
+        } else {
+          mCondition.wait(lock, ready);
+        }
+        if (mStop) {
+          return;
+        }
+        std::swap(commands, mCommands);
+      }
+
+      // Only the state after the last command is published, the renderer can't show the others.
+      for (auto& command : commands) {
+        apply(command);
+      }
+      commands.clear();
+      step(FRAME_SECONDS);
+      publish();
+    }
+  }
+
+  void BackgroundEngine::apply(Command& command) {
+    mCommandCount++;
+    switch (command.type) {
+      case CommandType::Load:
+        mNetlist = std::move(command.netlist);
+        mGeneration = command.generation;
+        mEngine.load(*mNetlist);
+        mClock.setClocks(command.firstClock, std::move(command.periods));
+        mClock.setHalfCycle(command.halfCycle);
+        if (!command.state.empty() && command.state.size() == mEngine.getStateWordCount()) {
+          mEngine.restoreState(command.state.data());
+          break;
+        }
+        for (u32 i = 0; i < command.inputs.size() && i < mNetlist->getInputs().size(); ++i) {
+          mEngine.setInput(i, command.inputs[i]);
+        }
+        mClock.apply(mEngine);
+        mEngine.evaluate();
+        break;
+      case CommandType::SetInput:
+        if (mNetlist && command.index < mNetlist->getInputs().size()) {
+          mEngine.propagate(command.index, command.value);
+        }
+        break;
+      case CommandType::Run:
+        mClock.start(command.frequency);
+        break;
+      case CommandType::Stop:
+        mClock.stop();
+        break;
+    }
+  }
+
+  void BackgroundEngine::step(f64 budgetSeconds) {
+    if (mNetlist) {
+      mClock.run(mEngine, budgetSeconds);
+    }
+  }
+
+  void BackgroundEngine::publish() {
+    if (!mNetlist) {
+      return;
+    }
+    auto& frame = mFrames.getWriteBuffer();
+    frame.generation = mGeneration;
+    frame.state.resize(mEngine.getStateWordCount());
+    mEngine.saveState(frame.state.data());
+    frame.commandCount = mCommandCount;
+    frame.halfCycle = mClock.getHalfCycle();
+    frame.frequency = mClock.getFrequency();
+    mFrames.publish();
+  }
+
+}
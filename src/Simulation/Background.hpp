@@ -0,0 +1,107 @@
+#pragma once
+
+#include "Core/Base.hpp"
+#include "Core/TripleBuffer.hpp"
+#include "Simulation/Netlist.hpp"
+#include "Simulation/Engine.hpp"
+#include "Simulation/Clock.hpp"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Gate::Simulation {
+
+  // An engine that runs on its own thread, so the render loop never waits for the simulation.
+  //
+  // Edits and clicks are sent as commands, they are applied in order. Once the queue is empty,
+  // the state of the engine (see Engine::saveState()) is published through a triple buffer,
+  // which the owner picks up once per frame with acquire().
+  //
+  // The clocks can run freely on the thread (see ClockDriver), a frame is then published every
+  // FRAME_SECONDS.
+  //
+  // On the web there are no threads, the commands are applied as soon as they are sent and the
+  // clocks run for a frame in acquire().
+  class BackgroundEngine {
+  public:
+    struct Frame {
+      // The generation of the netlist the state belongs to, see load().
+      u64 generation = 0;
+      std::vector<u64> state;
+
+      // Commands applied since the engine started.
+      u64 commandCount = 0;
+
+      u64 halfCycle = 0;
+      f64 frequency = 0.0;
+    };
+
+    static const constexpr f64 FRAME_SECONDS = 1.0 / 60.0;
+
+  public:
+    BackgroundEngine();
+    ~BackgroundEngine();
+    DISALLOW_MOVE_AND_COPY(BackgroundEngine);
+
+    // Replaces the netlist, the engine keeps its own copy. It is evaluated with the inputs, or
+    // resumes from the state if there is one (see Engine::restoreState()). The clocks continue
+    // from their half cycle.
+    void load(const Netlist& netlist, u64 generation, std::vector<u8> inputs, const ClockDriver& clocks, std::vector<u64> state = {});
+    void setInput(u32 index, bool value);
+
+    // See ClockDriver::start().
+    void run(f64 frequency);
+    void stop();
+
+    // The latest published frame, or nullptr if nothing was published since the last call.
+    const Frame* acquire();
+
+  private:
+    enum class CommandType : u8 {
+      Load,
+      SetInput,
+      Run,
+      Stop,
+    };
+
+    struct Command {
+      CommandType type;
+      u32 index;
+      bool value;
+      Ref<const Netlist> netlist;
+      u64 generation;
+      std::vector<u8> inputs;
+      std::vector<u64> state;
+      u32 firstClock;
+      std::vector<u32> periods;
+      u64 halfCycle;
+      f64 frequency;
+    };
+
+  private:
+    void push(Command command);
+    void work();
+    void apply(Command& command);
+    void step(f64 budgetSeconds);
+    void publish();
+
+  private:
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    std::vector<Command> mCommands;
+    bool mStop = false;
+
+    // Owned by the simulation thread
+    Ref<const Netlist> mNetlist;
+    Engine mEngine;
+    ClockDriver mClock;
+    u64 mGeneration = 0;
+    u64 mCommandCount = 0;
+
+    TripleBuffer<Frame> mFrames;
+    std::thread mThread;
+  };
+
+}
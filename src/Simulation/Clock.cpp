@@ -0,0 +1,107 @@
+#include "Simulation/Clock.hpp"
+
+#include <algorithm>
+
+namespace Gate::Simulation {
+
+  void ClockDriver::setClocks(u32 firstInput, std::vector<u32> periods) {
+    mFirstInput = firstInput;
+    mPeriods = std::move(periods);
+    for (auto& period : mPeriods) {
+      period = std::max(period, 1u);
+    }
+  }
+
+  void ClockDriver::setHalfCycle(u64 halfCycle) {
+    mHalfCycle = halfCycle;
+    resetSchedule();
+  }
+
+  void ClockDriver::apply(Engine& engine) const {
+    for (u32 i = 0; i < mPeriods.size(); ++i) {
+      engine.setInput(mFirstInput + i, getValue(i, mHalfCycle));
+    }
+  }
+
+  void ClockDriver::advance(Engine& engine, u64 halfCycles) {
+    // A clock only has an edge at the multiples of its period.
+    const u64 end = mHalfCycle + halfCycles;
+    for (u64 halfCycle = mHalfCycle + 1; halfCycle <= end; ++halfCycle) {
+      for (u32 i = 0; i < mPeriods.size(); ++i) {
+        if (halfCycle % mPeriods[i] == 0) {
+          engine.propagate(mFirstInput + i, getValue(i, halfCycle));
+        }
+      }
+      if (mHalfCycleHandler) {
+        mHalfCycle = halfCycle;
+        mHalfCycleHandler(halfCycle);
+      }
+    }
+    mHalfCycle = end;
+  }
+
+  void ClockDriver::start(f64 frequency) {
+    mRunning = true;
+    mTargetFrequency = std::max(frequency, 0.0);
+    mFrequency = 0.0;
+    resetSchedule();
+  }
+
+  void ClockDriver::stop() {
+    mRunning = false;
+    mFrequency = 0.0;
+  }
+
+  u64 ClockDriver::run(Engine& engine, f64 budgetSeconds) {
+    using Seconds = std::chrono::duration<f64>;
+    if (!mRunning || mPeriods.empty()) {
+      return 0;
+    }
+
+    const auto start = Clock::now();
+    const auto deadline = start + std::chrono::duration_cast<Clock::duration>(Seconds(budgetSeconds));
+    u64 target = UINT64_MAX;
+    if (mTargetFrequency > 0.0) {
+      target = mStartHalfCycle + u64(Seconds(start - mStartTime).count() * mTargetFrequency * 2.0);
+    }
+
+    // Reading the time costs more than a half cycle of a small chip, so it is only read between
+    // batches, which grow as long as they are short.
+    const u64 first = mHalfCycle;
+    u64 batch = 1;
+    auto now = start;
+    while (mHalfCycle < target && now < deadline) {
+      const auto batchStart = now;
+      advance(engine, std::min(batch, target - mHalfCycle));
+      now = Clock::now();
+      if (now - batchStart < (deadline - start) / 64) {
+        batch = std::min(batch * 2, MAX_BATCH);
+      }
+    }
+
+    const f64 elapsed = Seconds(now - mSampleTime).count();
+    if (elapsed >= SAMPLE_SECONDS) {
+      mFrequency = (mHalfCycle - mSampleHalfCycle) / 2.0 / elapsed;
+      mSampleTime = now;
+      mSampleHalfCycle = mHalfCycle;
+    }
+    return mHalfCycle - first;
+  }
+
+  f64 ClockDriver::getIdleSeconds() const {
+    using Seconds = std::chrono::duration<f64>;
+    if (!mRunning || mTargetFrequency <= 0.0) {
+      return 0.0;
+    }
+    const f64 due = (mHalfCycle + 1 - mStartHalfCycle) / (mTargetFrequency * 2.0);
+    return std::max(due - Seconds(Clock::now() - mStartTime).count(), 0.0);
+  }
+
+  void ClockDriver::resetSchedule() {
+    mStartTime = Clock::now();
+    mStartHalfCycle = mHalfCycle;
+    mSampleTime = mStartTime;
+    mSampleHalfCycle = mHalfCycle;
+  }
+
+}
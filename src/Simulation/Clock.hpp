@@ -0,0 +1,86 @@
+#pragma once
+
+#include "Core/Base.hpp"
+#include "Simulation/Engine.hpp"
+
+#include <chrono>
+#include <functional>
+#include <vector>
+
+namespace Gate::Simulation {
+
+  // Drives the clock inputs of a netlist, they come after the other inputs.
+  //
+  // Time advances in half cycles of the base clock. A clock with a period of n cycles is low for
+  // n half cycles, then high for n half cycles, so the base clock (n = 1) toggles every half cycle.
+  //
+  // In free-running mode the clocks follow the real time at a given frequency of the base clock,
+  // or run as fast as the engine can propagate their edges.
+  class ClockDriver {
+  public:
+    using Clock = std::chrono::steady_clock;
+    using HalfCycleHandler = std::function<void(u64 halfCycle)>;
+
+    // The achieved frequency is measured over this many seconds.
+    static const constexpr f64 SAMPLE_SECONDS = 0.5;
+
+    // Half cycles between two reads of the time, at most.
+    static const constexpr u64 MAX_BATCH = 1 << 16;
+
+  public:
+    void setClocks(u32 firstInput, std::vector<u32> periods);
+    inline u32 getFirstInput() const { return mFirstInput; }
+    inline u32 getClockCount() const { return (u32)mPeriods.size(); }
+    inline const std::vector<u32>& getPeriods() const { return mPeriods; }
+
+    inline u64 getHalfCycle() const { return mHalfCycle; }
+    void setHalfCycle(u64 halfCycle);
+    inline bool getValue(u32 clock, u64 halfCycle) const { return (halfCycle / mPeriods[clock]) & 1; }
+
+    // Sets the clock inputs to their values at the current half cycle, before Engine::evaluate().
+    void apply(Engine& engine) const;
+
+    // Advances by the given number of half cycles, every edge is propagated through the engine.
+    void advance(Engine& engine, u64 halfCycles);
+
+    // Called once the edges of every half cycle have been propagated, e.g. to record it.
+    inline void setHalfCycleHandler(HalfCycleHandler handler) { mHalfCycleHandler = std::move(handler); }
+
+    // A frequency of 0 runs the clocks as fast as possible.
+    void start(f64 frequency);
+    void stop();
+    inline bool isRunning() const { return mRunning; }
+    inline f64 getTargetFrequency() const { return mTargetFrequency; }
+
+    // Advances the clocks to where they should be by now, for at most the given time.
+    // Returns the number of half cycles.
+    u64 run(Engine& engine, f64 budgetSeconds);
+
+    // Seconds until the next half cycle is due, 0 when it is late.
+    f64 getIdleSeconds() const;
+
+    // Cycles per second of the base clock over the last sample.
+    inline f64 getFrequency() const { return mFrequency; }
+
+  private:
+    void resetSchedule();
+
+  private:
+    u32 mFirstInput = 0;
+    std::vector<u32> mPeriods;
+    u64 mHalfCycle = 0;
+    HalfCycleHandler mHalfCycleHandler;
+
+    // Free-running
+    bool mRunning = false;
+    f64 mTargetFrequency = 0.0;
+    Clock::time_point mStartTime;
+    u64 mStartHalfCycle = 0;
+
+    // Measurement of the achieved frequency
+    Clock::time_point mSampleTime;
+    u64 mSampleHalfCycle = 0;
+    f64 mFrequency = 0.0;
+  };
+
+}
@@ -0,0 +1,544 @@
+#include "Simulation/Engine.hpp"
+#include "Simulation/Kernels.hpp"
+#include "Core/ThreadPool.hpp"
+
+#include <algorithm>
+
+namespace Gate::Simulation {
+
+  static const constexpr u32 NO_LOOP = UINT32_MAX;
+
+  namespace {
+    // Index of every vector of word k, bit i is the value of inputs[i].
+    void gatherIndexes(const u64* words, usize stride, usize k, const std::vector<NetId>& inputs, u32 (&indexes)[64]) {
+      std::fill(indexes, indexes + 64, 0);
+      for (u32 i = 0; i < inputs.size(); ++i) {
+        const u64 word = words[usize(inputs[i]) * stride + k];
+        for (u32 lane = 0; lane < 64; ++lane) {
+          indexes[lane] |= u32((word >> lane) & 1) << i;
+        }
+      }
+    }
+  }
+
+  void Engine::load(const Netlist& netlist) {
+    mNetlist = &netlist;
+    mValues.assign(netlist.getNetCount(), 0);
+
+    auto& instructions = netlist.getInstructions();
+    mSourcesA.resize(instructions.size());
+    mSourcesB.resize(instructions.size());
+    mTargets.resize(instructions.size());
+    for (u32 i = 0; i < instructions.size(); ++i) {
+      mSourcesA[i] = instructions[i].a;
+      mSourcesB[i] = instructions[i].b;
+      mTargets[i]  = instructions[i].output;
+    }
+
+    auto& levels = netlist.getLevels();
+    mInstructionLevels.resize(instructions.size());
+    for (u32 level = 0; level < netlist.getLevelCount(); ++level) {
+      for (u32 i = levels[level]; i < levels[level + 1]; ++i) {
+        mInstructionLevels[i] = level;
+      }
+    }
+    mBuckets.assign(netlist.getLevelCount(), {});
+    mScheduled.assign(instructions.size(), 0);
+    mChanged.clear();
+
+    auto& loops = netlist.getLoops();
+    mInstructionLoops.assign(instructions.size(), NO_LOOP);
+    for (u32 loop = 0; loop < loops.size(); ++loop) {
+      for (u32 i = loops[loop].begin; i < loops[loop].end; ++i) {
+        mInstructionLoops[i] = loop;
+      }
+    }
+    mLoopScheduled.assign(loops.size(), 0);
+    mScheduledLoops.clear();
+    mOscillating.assign(loops.size(), 0);
+    mOscillatingCount = 0;
+
+    auto& memories = netlist.getMemories();
+    mReadCached.assign(memories.size(), 0);
+    mReadWords.assign(memories.size(), 0);
+    mCachedMemories.clear();
+    mMemoryContents.resize(memories.size());
+    for (u32 i = 0; i < memories.size(); ++i) {
+      mMemoryContents[i] = memories[i].getInitialContents();
+    }
+    mNative = nullptr;
+  }
+
+  u64 Engine::compute(const Instruction& instruction) const {
+    const u64* values = mValues.data();
+    switch (instruction.opcode) {
+      case Opcode::And:    return values[instruction.a] & values[instruction.b];
+      case Opcode::Or:     return values[instruction.a] | values[instruction.b];
+      case Opcode::Xor:    return values[instruction.a] ^ values[instruction.b];
+      case Opcode::Not:    return ~values[instruction.a];
+      case Opcode::Buffer: return values[instruction.a];
+      case Opcode::Merge: {
+        const NetId* operands = mNetlist->getOperands().data() + instruction.a;
+        u64 value = 0;
+        for (u32 i = 0; i < instruction.b; ++i) {
+          value |= values[operands[i]];
+        }
+        return value;
+      }
+      case Opcode::Lookup: {
+        auto& lookup = mNetlist->getLookups()[instruction.a];
+        u32 index = 0;
+        for (u32 i = 0; i < lookup.inputs.size(); ++i) {
+          index |= u32(values[lookup.inputs[i]] & 1) << i;
+        }
+        return lookup.table->get(instruction.b, index) ? ~u64(0) : 0;
+      }
+      case Opcode::Read:
+        break;
+    }
+    GATE_UNREACHABLE("reads are not computed one instruction at a time");
+  }
+
+  void Engine::execute(u64* words, usize stride) {
+    if (mNative) {
+      mNativeOscillating.assign(mNetlist->getLoops().size(), 0);
+      mNative->evaluate(words, stride, mNativeOscillating.data());
+      for (u32 loop = 0; loop < mNativeOscillating.size(); ++loop) {
+        setOscillating(loop, mNativeOscillating[loop]);
+      }
+      return;
+    }
+
+    auto& levels = mNetlist->getLevels();
+    auto& loops = mNetlist->getLoops();
+    auto& levelLoops = mNetlist->getLevelLoops();
+    const u32 levelCount = mNetlist->getLevelCount();
+
+    auto& pool = ThreadPool::get();
+    const bool parallel = mParallel
+      && pool.getThreadCount() > 1
+      && mNetlist->getInstructions().size() * stride >= PARALLEL_MIN_WORK;
+
+    for (u32 level = 0; level < levelCount; ++level) {
+      const u32 begin = levels[level];
+      const u32 end   = levelLoops[level] == levelLoops[level + 1] ? levels[level + 1] : loops[levelLoops[level]].begin;
+      const usize work = usize(end - begin) * stride;
+      if (!parallel || work < PARALLEL_MIN_LEVEL_WORK) {
+        executeRange(words, stride, level, begin, end);
+      } else {
+        // A few chunks per thread, so the workers can balance the load by stealing.
+        const usize chunkWork = std::max(PARALLEL_MIN_CHUNK_WORK, work / (pool.getThreadCount() * 4));
+        const u32 grain = (u32)std::max<usize>(1, chunkWork / stride);
+        pool.parallelFor(end - begin, grain, [&](u32 chunkBegin, u32 chunkEnd) {
+          executeRange(words, stride, level, begin + chunkBegin, begin + chunkEnd);
+        });
+      }
+
+      for (u32 loop = levelLoops[level]; loop < levelLoops[level + 1]; ++loop) {
+        executeLoop(words, stride, loop);
+      }
+    }
+  }
+
+  void Engine::executeLoop(u64* words, usize stride, u32 loopIndex) {
+    auto& loop = mNetlist->getLoops()[loopIndex];
+    auto& instructions = mNetlist->getInstructions();
+    auto snapshot = [&](std::vector<u64>& values) {
+      values.clear();
+      for (u32 i = loop.begin; i < loop.end; ++i) {
+        const NetId net = instructions[i].output;
+        values.insert(values.end(), words + usize(net) * stride, words + usize(net + 1) * stride);
+      }
+    };
+
+    // The loop has settled once a whole pass doesn't change any of its outputs.
+    const u32 maxIterations = LOOP_ITERATION_FACTOR * (loop.end - loop.begin) + 1;
+    snapshot(mLoopValues);
+    for (u32 iteration = 0; iteration < maxIterations; ++iteration) {
+      executeInOrder(words, stride, loop.begin, loop.end);
+      mLoopStartValues.swap(mLoopValues);
+      snapshot(mLoopValues);
+      if (mLoopValues == mLoopStartValues) {
+        setOscillating(loopIndex, false);
+        return;
+      }
+    }
+    setOscillating(loopIndex, true);
+  }
+
+  void Engine::setOscillating(u32 loop, bool oscillating) {
+    if (mOscillating[loop] != oscillating) {
+      mOscillating[loop] = oscillating;
+      mOscillatingCount += oscillating ? 1 : -1;
+    }
+  }
+
+  usize Engine::getStateWordCount() const {
+    usize count = (mValues.size() + 63) / 64 + (mOscillating.size() + 63) / 64;
+    for (auto& contents : mMemoryContents) {
+      count += (contents.size() + 7) / 8;
+    }
+    return count;
+  }
+
+  void Engine::saveState(u64* words) const {
+    const usize netWords = (mValues.size() + 63) / 64;
+    std::fill(words, words + getStateWordCount(), 0);
+    for (usize net = 0; net < mValues.size(); ++net) {
+      words[net / 64] |= (mValues[net] & 1) << (net % 64);
+    }
+    for (usize loop = 0; loop < mOscillating.size(); ++loop) {
+      words[netWords + loop / 64] |= u64(mOscillating[loop]) << (loop % 64);
+    }
+    u64* memoryWords = words + netWords + (mOscillating.size() + 63) / 64;
+    for (auto& contents : mMemoryContents) {
+      for (usize i = 0; i < contents.size(); ++i) {
+        memoryWords[i / 8] |= u64(contents[i]) << (i % 8 * 8);
+      }
+      memoryWords += (contents.size() + 7) / 8;
+    }
+  }
+
+  void Engine::restoreState(const u64* words) {
+    const usize netWords = (mValues.size() + 63) / 64;
+    mChanged.clear();
+    for (usize net = 0; net < mValues.size(); ++net) {
+      const u64 value = (words[net / 64] >> (net % 64)) & 1 ? ~u64(0) : 0;
+      if (value != mValues[net]) {
+        mValues[net] = value;
+        mChanged.push_back((NetId)net);
+      }
+    }
+    for (u32 loop = 0; loop < mOscillating.size(); ++loop) {
+      setOscillating(loop, (words[netWords + loop / 64] >> (loop % 64)) & 1);
+    }
+    const u64* memoryWords = words + netWords + (mOscillating.size() + 63) / 64;
+    for (auto& contents : mMemoryContents) {
+      for (usize i = 0; i < contents.size(); ++i) {
+        contents[i] = u8(memoryWords[i / 8] >> (i % 8 * 8));
+      }
+      memoryWords += (contents.size() + 7) / 8;
+    }
+  }
+
+  void Engine::executeRange(u64* words, usize stride, u32 level, u32 begin, u32 end) {
+    auto& groups = mNetlist->getGroups();
+    auto& levelGroups = mNetlist->getLevelGroups();
+    for (u32 i = levelGroups[level]; i < levelGroups[level + 1]; ++i) {
+      auto& group = groups[i];
+      const u32 groupBegin = std::max(begin, group.begin);
+      const u32 groupEnd   = std::min(end, group.end);
+      if (groupBegin >= groupEnd) {
+        continue;
+      }
+      switch (group.opcode) {
+        case Opcode::And:
+        case Opcode::Or:
+        case Opcode::Xor:
+        case Opcode::Not:
+        case Opcode::Buffer:
+          Kernels::get(group.opcode)(
+            words,
+            stride,
+            mSourcesA.data() + groupBegin,
+            mSourcesB.data() + groupBegin,
+            mTargets.data() + groupBegin,
+            groupEnd - groupBegin
+          );
+          break;
+        case Opcode::Merge:
+        case Opcode::Lookup:
+        case Opcode::Read:
+          executeInOrder(words, stride, groupBegin, groupEnd);
+          break;
+      }
+    }
+  }
+
+  void Engine::executeInOrder(u64* words, usize stride, u32 begin, u32 end) {
+    auto& instructions = mNetlist->getInstructions();
+    const NetId* operands = mNetlist->getOperands().data();
+    for (u32 i = begin; i < end; ++i) {
+      auto& instruction = instructions[i];
+      switch (instruction.opcode) {
+        case Opcode::And:
+        case Opcode::Or:
+        case Opcode::Xor:
+        case Opcode::Not:
+        case Opcode::Buffer:
+          Kernels::get(instruction.opcode)(words, stride, &instruction.a, &instruction.b, &instruction.output, 1);
+          break;
+        case Opcode::Merge: {
+          u64* output = words + usize(instruction.output) * stride;
+          std::fill(output, output + stride, 0);
+          for (u32 j = 0; j < instruction.b; ++j) {
+            const u64* input = words + usize(operands[instruction.a + j]) * stride;
+            for (usize k = 0; k < stride; ++k) {
+              output[k] |= input[k];
+            }
+          }
+        } break;
+        case Opcode::Lookup:
+          lookup(words, stride, instruction);
+          break;
+        case Opcode::Read:
+          // The rest of the reads of the memory are done with this one.
+          i = read(words, stride, i, end) - 1;
+          break;
+      }
+    }
+  }
+
+  void Engine::lookup(u64* words, usize stride, const Instruction& instruction) {
+    auto& lookup = mNetlist->getLookups()[instruction.a];
+    u64* output = words + usize(instruction.output) * stride;
+    if (words == mValues.data()) {
+      *output = compute(instruction);
+      return;
+    }
+
+    // Every vector has its own index, they are gathered a lane at a time.
+    for (usize k = 0; k < stride; ++k) {
+      u32 indexes[64];
+      gatherIndexes(words, stride, k, lookup.inputs, indexes);
+      u64 value = 0;
+      for (u32 lane = 0; lane < 64; ++lane) {
+        value |= u64(lookup.table->get(instruction.b, indexes[lane])) << lane;
+      }
+      output[k] = value;
+    }
+  }
+
+  u32 Engine::read(u64* words, usize stride, u32 begin, u32 end) {
+    auto& instructions = mNetlist->getInstructions();
+    const u32 memoryIndex = instructions[begin].a;
+    auto& memory = mNetlist->getMemories()[memoryIndex];
+    const u8* contents = mMemoryContents[memoryIndex].data();
+
+    // The reads of a memory are emitted together, the address is decoded and the word read
+    // once for all of them.
+    u32 last = begin + 1;
+    while (last < end && instructions[last].opcode == Opcode::Read && instructions[last].a == memoryIndex) {
+      last++;
+    }
+
+    if (words == mValues.data()) {
+      const u64 word = Memory::readWord(contents, memory.dataWidth, (u32)getWord(memory.address));
+      for (u32 i = begin; i < last; ++i) {
+        mValues[instructions[i].output] = (word >> instructions[i].b) & 1 ? ~u64(0) : 0;
+      }
+      return last;
+    }
+
+    for (usize k = 0; k < stride; ++k) {
+      u32 indexes[64];
+      u64 laneWords[64];
+      gatherIndexes(words, stride, k, memory.address, indexes);
+      for (u32 lane = 0; lane < 64; ++lane) {
+        laneWords[lane] = Memory::readWord(contents, memory.dataWidth, indexes[lane]);
+      }
+      for (u32 i = begin; i < last; ++i) {
+        const u32 bit = instructions[i].b;
+        u64 value = 0;
+        for (u32 lane = 0; lane < 64; ++lane) {
+          value |= ((laneWords[lane] >> bit) & 1) << lane;
+        }
+        words[usize(instructions[i].output) * stride + k] = value;
+      }
+    }
+    return last;
+  }
+
+  u64 Engine::readBit(const Instruction& instruction) {
+    // Every read of a memory in a wave sees the same address, the word is only read by the first one.
+    if (!mReadCached[instruction.a]) {
+      auto& memory = mNetlist->getMemories()[instruction.a];
+      mReadCached[instruction.a] = 1;
+      mReadWords[instruction.a] = Memory::readWord(mMemoryContents[instruction.a].data(), memory.dataWidth, (u32)getWord(memory.address));
+      mCachedMemories.push_back(instruction.a);
+    }
+    return (mReadWords[instruction.a] >> instruction.b) & 1 ? ~u64(0) : 0;
+  }
+
+  void Engine::evaluate() {
+    execute(mValues.data(), 1);
+  }
+
+  void Engine::propagateLoop(u32 loopIndex) {
+    auto& loop = mNetlist->getLoops()[loopIndex];
+    auto& instructions = mNetlist->getInstructions();
+    auto forEachOutput = [&](auto&& function) {
+      for (u32 i = loop.begin; i < loop.end; ++i) {
+        function(instructions[i].output);
+      }
+    };
+
+    auto& previous = mLoopPreviousValues;
+    previous.clear();
+    forEachOutput([&](NetId net) { previous.push_back(mValues[net]); });
+    executeLoop(mValues.data(), 1, loopIndex);
+    usize index = 0;
+    forEachOutput([&](NetId net) {
+      if (mValues[net] != previous[index++]) {
+        mChanged.push_back(net);
+        schedule(net);
+      }
+    });
+  }
+
+  void Engine::schedule(NetId net) {
+    for (auto it = mNetlist->fanoutBegin(net); it != mNetlist->fanoutEnd(net); ++it) {
+      scheduleInstruction(*it);
+    }
+  }
+
+  void Engine::scheduleInstruction(u32 index) {
+    if (!mScheduled[index]) {
+      mScheduled[index] = 1;
+      mBuckets[mInstructionLevels[index]].push_back(index);
+    }
+  }
+
+  void Engine::propagate(u32 input, bool value) {
+    mChanged.clear();
+
+    NetId net = mNetlist->getInputs()[input];
+    if (getValue(net) == value) {
+      return;
+    }
+    setValue(net, value);
+    mChanged.push_back(net);
+    schedule(net);
+    settle();
+
+    auto& registers = mNetlist->getRegisters();
+    auto& memories  = mNetlist->getMemories();
+    usize checked = 0;
+    for (usize wave = 0; wave < registers.size() + memories.size() + 1 && checked < mChanged.size(); ++wave) {
+      mClockedValues.clear();
+      mMemoryWrites.clear();
+      for (; checked < mChanged.size(); ++checked) {
+        NetId changed = mChanged[checked];
+        if (!getValue(changed)) {
+          continue;
+        }
+        for (auto it = mNetlist->clockedRegistersBegin(changed); it != mNetlist->clockedRegistersEnd(changed); ++it) {
+          auto& reg = registers[*it];
+          mClockedValues.emplace_back(reg.q, mValues[reg.d]);
+        }
+        for (auto it = mNetlist->clockedMemoriesBegin(changed); it != mNetlist->clockedMemoriesEnd(changed); ++it) {
+          auto& memory = memories[*it];
+          if (getValue(memory.write)) {
+            mMemoryWrites.push_back(MemoryWrite{*it, (u32)getWord(memory.address), getWord(memory.data)});
+          }
+        }
+      }
+      if (mClockedValues.empty() && mMemoryWrites.empty()) {
+        break;
+      }
+      for (auto&[q, sampled] : mClockedValues) {
+        if (mValues[q] != sampled) {
+          mValues[q] = sampled;
+          mChanged.push_back(q);
+          schedule(q);
+        }
+      }
+      for (auto& write : mMemoryWrites) {
+        u8* contents = mMemoryContents[write.memory].data();
+        const u32 dataWidth = memories[write.memory].dataWidth;
+        if (Memory::readWord(contents, dataWidth, write.index) != write.value) {
+          Memory::writeWord(contents, dataWidth, write.index, write.value);
+          for (auto it = mNetlist->readersBegin(write.memory); it != mNetlist->readersEnd(write.memory); ++it) {
+            scheduleInstruction(*it);
+          }
+        }
+      }
+      settle();
+    }
+  }
+
+  u64 Engine::getWord(const std::vector<NetId>& nets) const {
+    u64 word = 0;
+    for (u32 i = 0; i < nets.size(); ++i) {
+      word |= u64(mValues[nets[i]] & 1) << i;
+    }
+    return word;
+  }
+
+  void Engine::settle() {
+    auto& instructions = mNetlist->getInstructions();
+    for (auto& bucket : mBuckets) {
+      // The outputs of a loop schedule its own instructions, so the bucket can grow while it is processed.
+      for (usize i = 0; i < bucket.size(); ++i) {
+        // Loops only read lower levels, so they are evaluated as a whole once per propagation.
+        if (u32 loop = mInstructionLoops[bucket[i]]; loop != NO_LOOP) {
+          if (!mLoopScheduled[loop]) {
+            mLoopScheduled[loop] = 1;
+            mScheduledLoops.push_back(loop);
+            propagateLoop(loop);
+          }
+          continue;
+        }
+
+        auto& instruction = instructions[bucket[i]];
+        u64 result = instruction.opcode == Opcode::Read ? readBit(instruction) : compute(instruction);
+        if (result != mValues[instruction.output]) {
+          mValues[instruction.output] = result;
+          mChanged.push_back(instruction.output);
+          schedule(instruction.output);
+        }
+      }
+    }
+
+    // Every instruction is evaluated at most once per wave.
+    for (auto& bucket : mBuckets) {
+      for (auto index : bucket) {
+        mScheduled[index] = 0;
+      }
+      bucket.clear();
+    }
+    for (auto loop : mScheduledLoops) {
+      mLoopScheduled[loop] = 0;
+    }
+    mScheduledLoops.clear();
+    for (auto memory : mCachedMemories) {
+      mReadCached[memory] = 0;
+    }
+    mCachedMemories.clear();
+  }
+
+  std::vector<u64> Engine::simulate(Slice<const u64> inputs) {
+    auto& netlistInputs  = mNetlist->getInputs();
+    auto& netlistOutputs = mNetlist->getOutputs();
+
+    const usize inputCount = netlistInputs.size();
+    const usize batchCount = inputCount == 0 ? 1 : inputs.size() / inputCount;
+    GATE_ASSERT_WITH_MESSAGE(inputs.size() == batchCount * inputCount, "input words must be a multiple of the input count");
+
+    std::vector<u64> outputs(batchCount * netlistOutputs.size());
+
+    // Batches are evaluated side by side, up to MAX_STRIDE words per net.
+    for (usize first = 0; first < batchCount; first += MAX_STRIDE) {
+      const usize stride = std::min(MAX_STRIDE, batchCount - first);
+      mWords.assign(mNetlist->getNetCount() * stride, 0);
+      for (auto& reg : mNetlist->getRegisters()) {
+        std::fill(mWords.begin() + reg.q * stride, mWords.begin() + (reg.q + 1) * stride, mValues[reg.q]);
+      }
+      for (usize batch = 0; batch < stride; ++batch) {
+        for (usize i = 0; i < inputCount; ++i) {
+          mWords[netlistInputs[i] * stride + batch] = inputs.data()[(first + batch) * inputCount + i];
+        }
+      }
+
+      execute(mWords.data(), stride);
+
+      for (usize batch = 0; batch < stride; ++batch) {
+        for (usize i = 0; i < netlistOutputs.size(); ++i) {
+          outputs[(first + batch) * netlistOutputs.size() + i] = mWords[netlistOutputs[i] * stride + batch];
+        }
+      }
+    }
+    return outputs;
+  }
+
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include "Core/Base.hpp"
+#include "Simulation/Netlist.hpp"
+#include "Simulation/Native.hpp"
+
+#include <vector>
+
+namespace Gate::Simulation {
+
+  class Engine {
+  public:
+    // Words per net in a single bit-parallel pass (64 vectors per word).
+    static const constexpr usize MAX_STRIDE = 16;
+
+    // Cost model of the parallel evaluation, in words computed. Smaller netlists
+    // and levels are evaluated on the calling thread.
+    static const constexpr usize PARALLEL_MIN_WORK       = 1 << 16;
+    static const constexpr usize PARALLEL_MIN_LEVEL_WORK = 1 << 12;
+    static const constexpr usize PARALLEL_MIN_CHUNK_WORK = 1 << 10;
+
+    // A feedback loop is evaluated up to this many times its size, enough for a change to
+    // go around it twice. Loops that haven't settled by then are oscillating.
+    static const constexpr u32 LOOP_ITERATION_FACTOR = 2;
+
+  public:
+    void load(const Netlist& netlist);
+    void evaluate();
+
+    // Changes a single input and re-evaluates only its fanout cone, propagation
+    // stops at the instructions whose output doesn't change.
+    //
+    // Registers and memories are clocked by the rising edges once the cone has settled, they
+    // all sample their inputs before any of them changes. The changes are propagated in turn,
+    // their edges can clock other registers, up to one wave per register and memory.
+    //
+    // NOTE: The state has to be consistent, so evaluate() must be called after load().
+    void propagate(u32 input, bool value);
+
+    // Evaluates 64 independent input vectors at once, bit i of a word belongs to vector i.
+    // The registers and memories keep their current contents in every vector.
+    //
+    // The words are laid out in batches of one word per input, the result has
+    // one word per output for every batch.
+    std::vector<u64> simulate(Slice<const u64> inputs);
+
+    // Every net after the last pass of simulate(), the words of its (up to MAX_STRIDE) batches
+    // are side by side.
+    inline const std::vector<u64>& getSimulatedWords() const { return mWords; }
+
+    // Nets that have changed during the last propagate() or restoreState() call.
+    inline const std::vector<NetId>& getChangedNets() const { return mChanged; }
+
+    // Loops (see Netlist::getLoops()) that didn't settle the last time they were evaluated.
+    inline bool isOscillating(u32 loop) const { return mOscillating[loop]; }
+    inline u32 getOscillatingCount() const { return mOscillatingCount; }
+
+    // Evaluate large levels in chunks on the shared thread pool.
+    inline void setParallel(bool enable) { mParallel = enable; }
+    inline bool isParallel() const { return mParallel; }
+
+    // Full evaluations (evaluate() and simulate()) run the compiled module instead of
+    // interpreting the netlist, it is dropped when a netlist is loaded.
+    inline void setNative(NativeModule::Handle module) { mNative = std::move(module); }
+    inline bool isNative() const { return mNative != nullptr; }
+
+    // Scalar values are stored as words with all the bits set or cleared.
+    inline void setInput(u32 index, bool value) { mValues[mNetlist->getInputs()[index]] = value ? ~u64(0) : 0; }
+    inline bool getValue(NetId net) const { return mValues[net] & 1; }
+    inline void setValue(NetId net, bool value) { mValues[net] = value ? ~u64(0) : 0; }
+
+    // The scalar state, the value of every net followed by the oscillating loops, one bit each,
+    // and the contents of the memories. Feedback loops keep their state in their nets, so this
+    // is all that is needed to resume the simulation of the same netlist.
+    usize getStateWordCount() const;
+    void saveState(u64* words) const;
+    void restoreState(const u64* words);
+
+  private:
+    struct MemoryWrite {
+      u32 memory;
+      u32 index;
+      u64 value;
+    };
+
+  private:
+    u64 compute(const Instruction& instruction) const;
+    void execute(u64* words, usize stride);
+    void executeRange(u64* words, usize stride, u32 level, u32 begin, u32 end);
+    void executeInOrder(u64* words, usize stride, u32 begin, u32 end);
+    void executeLoop(u64* words, usize stride, u32 loop);
+    void propagateLoop(u32 loop);
+    void settle();
+    void setOscillating(u32 loop, bool oscillating);
+    void lookup(u64* words, usize stride, const Instruction& instruction);
+
+    // Evaluates the reads of the memory of instruction begin that follow it (up to end), and
+    // returns the index after the last one.
+    u32 read(u64* words, usize stride, u32 begin, u32 end);
+    u64 readBit(const Instruction& instruction);
+
+    void schedule(NetId net);
+    void scheduleInstruction(u32 index);
+
+    // The value of the nets as a word, net i is bit i.
+    u64 getWord(const std::vector<NetId>& nets) const;
+
+  private:
+    const Netlist* mNetlist = nullptr;
+    std::vector<u64> mValues;
+    bool mParallel = true;
+    NativeModule::Handle mNative;
+    std::vector<u8> mNativeOscillating;
+
+    // Operands of the instructions as separate arrays, used by the kernels
+    std::vector<NetId> mSourcesA;
+    std::vector<NetId> mSourcesB;
+    std::vector<NetId> mTargets;
+
+    // Incremental propagation state
+    std::vector<u32> mInstructionLevels;
+    std::vector<std::vector<u32>> mBuckets;
+    std::vector<u8> mScheduled;
+    std::vector<NetId> mChanged;
+    std::vector<u32> mInstructionLoops;
+    std::vector<u8> mLoopScheduled;
+    std::vector<u32> mScheduledLoops;
+    std::vector<std::pair<NetId, u64>> mClockedValues;
+    std::vector<MemoryWrite> mMemoryWrites;
+
+    // Feedback loop state
+    std::vector<u8> mOscillating;
+    u32 mOscillatingCount = 0;
+    std::vector<u64> mLoopValues;
+    std::vector<u64> mLoopStartValues;
+    std::vector<u64> mLoopPreviousValues;
+
+    std::vector<std::vector<u8>> mMemoryContents;
+
+    // Words read by the current wave of propagate(), per memory
+    std::vector<u8> mReadCached;
+    std::vector<u64> mReadWords;
+    std::vector<u32> mCachedMemories;
+
+    // Bit-parallel state, stride words of 64 vectors per net
+    std::vector<u64> mWords;
+  };
+
+}
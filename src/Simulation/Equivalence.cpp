@@ -0,0 +1,339 @@
+#include "Simulation/Equivalence.hpp"
+#include "Simulation/Engine.hpp"
+#include "Simulation/Sat.hpp"
+#include "Simulation/Vectors.hpp"
+
+#include <algorithm>
+#include <map>
+#include <tuple>
+
+namespace Gate::Simulation {
+
+  namespace {
+    using Literal = SatSolver::Literal;
+
+    // Vectors simulated at once while screening, a few full passes of the engine.
+    static const constexpr u64 SCREENING_VECTORS = 64 * Engine::MAX_STRIDE * 64;
+
+    // Tseitin encoding of the gates of both netlists, with constant folding and structural hashing.
+    struct Encoder {
+      enum class Kind : u8 {
+        And,
+        Xor,
+        Mux,
+      };
+
+      SatSolver& solver;
+      Literal falseLiteral;
+      std::map<std::tuple<Kind, Literal, Literal, Literal>, Literal> gates;
+
+      explicit Encoder(SatSolver& solver)
+        : solver{solver}, falseLiteral{SatSolver::literal(solver.addVariable())}
+      {
+        solver.addClause({falseLiteral ^ 1});
+      }
+
+      inline Literal trueLiteral() const { return falseLiteral ^ 1; }
+      inline bool isConstant(Literal literal) const { return (literal | 1) == (falseLiteral | 1); }
+
+      // Returns the variable of a new gate, or of the identical one that was already encoded.
+      bool find(Kind kind, Literal a, Literal b, Literal c, Literal& output) {
+        auto[it, inserted] = gates.try_emplace(std::make_tuple(kind, a, b, c), 0);
+        if (inserted) {
+          it->second = SatSolver::literal(solver.addVariable());
+        }
+        output = it->second;
+        return inserted;
+      }
+
+      Literal andGate(Literal a, Literal b) {
+        if (a == falseLiteral || b == falseLiteral || a == (b ^ 1)) {
+          return falseLiteral;
+        }
+        if (a == trueLiteral() || a == b) {
+          return b;
+        }
+        if (b == trueLiteral()) {
+          return a;
+        }
+        if (a > b) {
+          std::swap(a, b);
+        }
+        Literal output;
+        if (find(Kind::And, a, b, 0, output)) {
+          solver.addClause({output ^ 1, a});
+          solver.addClause({output ^ 1, b});
+          solver.addClause({output, a ^ 1, b ^ 1});
+        }
+        return output;
+      }
+
+      Literal orGate(Literal a, Literal b) {
+        return andGate(a ^ 1, b ^ 1) ^ 1;
+      }
+
+      Literal xorGate(Literal a, Literal b) {
+        if (isConstant(a)) {
+          return b ^ Literal(a == trueLiteral());
+        }
+        if (isConstant(b)) {
+          return a ^ Literal(b == trueLiteral());
+        }
+        // The inversions are moved to the output, so a ^ b and ~a ^ b share their variable.
+        const Literal inverted = (a ^ b) & 1;
+        a &= ~Literal(1);
+        b &= ~Literal(1);
+        if (a == b) {
+          return falseLiteral ^ inverted;
+        }
+        if (a > b) {
+          std::swap(a, b);
+        }
+        Literal output;
+        if (find(Kind::Xor, a, b, 0, output)) {
+          solver.addClause({output ^ 1, a, b});
+          solver.addClause({output ^ 1, a ^ 1, b ^ 1});
+          solver.addClause({output, a ^ 1, b});
+          solver.addClause({output, a, b ^ 1});
+        }
+        return output ^ inverted;
+      }
+
+      // select ? high : low
+      Literal mux(Literal select, Literal high, Literal low) {
+        if (high == low || select == trueLiteral()) {
+          return high;
+        }
+        if (select == falseLiteral) {
+          return low;
+        }
+        if (high == (low ^ 1)) {
+          return xorGate(select, low);
+        }
+        if (isConstant(high)) {
+          return high == trueLiteral() ? orGate(select, low) : andGate(select ^ 1, low);
+        }
+        if (isConstant(low)) {
+          return low == trueLiteral() ? orGate(select ^ 1, high) : andGate(select, high);
+        }
+        if (SatSolver::isNegated(select)) {
+          select ^= 1;
+          std::swap(high, low);
+        }
+        Literal output;
+        if (find(Kind::Mux, select, high, low, output)) {
+          solver.addClause({select ^ 1, high ^ 1, output});
+          solver.addClause({select ^ 1, high, output ^ 1});
+          solver.addClause({select, low ^ 1, output});
+          solver.addClause({select, low, output ^ 1});
+          // Redundant, but they let the output be deduced from equal data inputs.
+          solver.addClause({high ^ 1, low ^ 1, output});
+          solver.addClause({high, low, output ^ 1});
+        }
+        return output;
+      }
+
+      // Output b of a truth table, as a tree of multiplexers on its inputs from the lowest one.
+      // Identical subtables end up as the same gate, so the tree is a reduced decision diagram.
+      Literal lookup(const Lookup& lookup, u32 output, const std::vector<Literal>& nets) {
+        const u32 inputCount = lookup.table->inputCount;
+        std::vector<Literal> entries(usize(1) << inputCount);
+        for (u32 i = 0; i < entries.size(); ++i) {
+          entries[i] = lookup.table->get(output, i) ? trueLiteral() : falseLiteral;
+        }
+        for (u32 j = 0; j < inputCount; ++j) {
+          const Literal select = nets[lookup.inputs[j]];
+          for (usize m = 0; m < entries.size() / 2; ++m) {
+            entries[m] = mux(select, entries[2 * m + 1], entries[2 * m]);
+          }
+          entries.resize(entries.size() / 2);
+        }
+        return entries[0];
+      }
+
+      // Undriven nets are low, as in the engine.
+      std::vector<Literal> encode(const Netlist& netlist, const std::vector<Literal>& inputs) {
+        std::vector<Literal> nets(netlist.getNetCount(), falseLiteral);
+        for (usize i = 0; i < inputs.size(); ++i) {
+          nets[netlist.getInputs()[i]] = inputs[i];
+        }
+        for (auto& instruction : netlist.getInstructions()) {
+          Literal value = falseLiteral;
+          switch (instruction.opcode) {
+            case Opcode::And:    value = andGate(nets[instruction.a], nets[instruction.b]); break;
+            case Opcode::Or:     value = orGate(nets[instruction.a], nets[instruction.b]);  break;
+            case Opcode::Xor:    value = xorGate(nets[instruction.a], nets[instruction.b]); break;
+            case Opcode::Not:    value = nets[instruction.a] ^ 1; break;
+            case Opcode::Buffer: value = nets[instruction.a]; break;
+            case Opcode::Merge: {
+              const NetId* operands = netlist.getOperands().data() + instruction.a;
+              for (u32 i = 0; i < instruction.b; ++i) {
+                value = orGate(value, nets[operands[i]]);
+              }
+              break;
+            }
+            case Opcode::Lookup:
+              value = lookup(netlist.getLookups()[instruction.a], instruction.b, nets);
+              break;
+            case Opcode::Read:
+              GATE_UNREACHABLE("memories can't be encoded");
+          }
+          nets[instruction.output] = value;
+        }
+
+        std::vector<Literal> outputs;
+        for (auto net : netlist.getOutputs()) {
+          outputs.push_back(nets[net]);
+        }
+        return outputs;
+      }
+    };
+
+    // Simulates a single vector on both netlists, and fills the counterexample of the report.
+    bool setCounterexample(const Netlist& a, const Netlist& b, std::vector<u8> inputs, EquivalenceChecker::Report& report) {
+      std::vector<u64> words(inputs.size());
+      for (usize i = 0; i < inputs.size(); ++i) {
+        words[i] = inputs[i] ? ~u64(0) : 0;
+      }
+      Engine engine;
+      engine.load(a);
+      const auto outputsA = engine.simulate(Slice<const u64>(words.data(), words.size()));
+      engine.load(b);
+      const auto outputsB = engine.simulate(Slice<const u64>(words.data(), words.size()));
+
+      report.counterexample = std::move(inputs);
+      report.outputsA.resize(outputsA.size());
+      report.outputsB.resize(outputsB.size());
+      for (usize i = 0; i < outputsA.size(); ++i) {
+        report.outputsA[i] = u8(outputsA[i] & 1);
+        report.outputsB[i] = u8(outputsB[i] & 1);
+      }
+      return report.outputsA != report.outputsB;
+    }
+
+    // Simulates vectorCount vectors on both netlists, and stops at the first one that differs.
+    bool screen(const Netlist& a, const Netlist& b, u64 vectorCount, bool exhaustive, u64 seed, EquivalenceChecker::Report& report) {
+      const usize inputCount  = a.getInputs().size();
+      const usize outputCount = a.getOutputs().size();
+
+      Engine engineA;
+      Engine engineB;
+      engineA.load(a);
+      engineB.load(b);
+
+      std::vector<u64> inputs;
+      u64 state = seed;
+      for (u64 first = 0; first < vectorCount; first += SCREENING_VECTORS) {
+        const u64 count = std::min(SCREENING_VECTORS, vectorCount - first);
+        const usize batchCount = usize((count + 63) / 64);
+        inputs.resize(batchCount * inputCount);
+        for (usize batch = 0; batch < batchCount; ++batch) {
+          for (usize i = 0; i < inputCount; ++i) {
+            inputs[batch * inputCount + i] = exhaustive ? indexBits(first / 64 + batch, (u32)i) : splitMix(state);
+          }
+        }
+
+        // Without inputs there is a single batch.
+        const usize wordCount = inputCount == 0 ? 0 : inputs.size();
+        const auto outputsA = engineA.simulate(Slice<const u64>(inputs.data(), wordCount));
+        const auto outputsB = engineB.simulate(Slice<const u64>(inputs.data(), wordCount));
+        report.vectorCount += count;
+
+        for (usize batch = 0; batch < outputsA.size() / std::max<usize>(outputCount, 1); ++batch) {
+          u64 difference = 0;
+          for (usize i = 0; i < outputCount; ++i) {
+            difference |= outputsA[batch * outputCount + i] ^ outputsB[batch * outputCount + i];
+          }
+          const u64 laneCount = std::min<u64>(64, count - batch * 64);
+          if (laneCount < 64) {
+            difference &= (u64(1) << laneCount) - 1;
+          }
+          if (difference == 0) {
+            continue;
+          }
+
+          u32 lane = 0;
+          while (((difference >> lane) & 1) == 0) {
+            lane++;
+          }
+          std::vector<u8> vector(inputCount);
+          for (usize i = 0; i < inputCount; ++i) {
+            vector[i] = u8((inputs[batch * inputCount + i] >> lane) & 1);
+          }
+          setCounterexample(a, b, std::move(vector), report);
+          return false;
+        }
+      }
+      return true;
+    }
+  }
+
+  EquivalenceChecker::Report EquivalenceChecker::check(const Netlist& a, const Netlist& b, const Options& options) {
+    GATE_ASSERT_WITH_MESSAGE(a.getInputs().size() == b.getInputs().size() && a.getOutputs().size() == b.getOutputs().size(), "the netlists must have the same pins");
+
+    const usize inputCount = a.getInputs().size();
+    Report report;
+
+    if (inputCount <= EXHAUSTIVE_INPUTS) {
+      report.method = Method::Exhaustive;
+      const bool equivalent = screen(a, b, u64(1) << inputCount, true, 0, report);
+      report.result = equivalent ? Result::Equivalent : Result::Different;
+      return report;
+    }
+
+    report.method = Method::Random;
+    if (!screen(a, b, options.randomVectors, false, options.seed, report)) {
+      report.result = Result::Different;
+      return report;
+    }
+    if (!a.getLoops().empty() || !b.getLoops().empty() || !a.getMemories().empty() || !b.getMemories().empty()) {
+      return report;
+    }
+
+    // The miter is satisfiable if an output of a differs from the same output of b.
+    report.method = Method::Sat;
+    SatSolver solver;
+    Encoder encoder(solver);
+    std::vector<Literal> inputs(inputCount);
+    for (auto& input : inputs) {
+      input = SatSolver::literal(solver.addVariable());
+    }
+    const auto outputsA = encoder.encode(a, inputs);
+    const auto outputsB = encoder.encode(b, inputs);
+    std::vector<Literal> differences;
+    for (usize i = 0; i < outputsA.size(); ++i) {
+      const Literal difference = encoder.xorGate(outputsA[i], outputsB[i]);
+      if (difference != encoder.falseLiteral) {
+        differences.push_back(difference);
+      }
+    }
+
+    SatSolver::Result result = SatSolver::Result::Unsatisfiable;
+    if (!differences.empty() && solver.addClause(differences)) {
+      result = solver.solve(options.conflictLimit);
+    }
+    report.variableCount = solver.getVariableCount();
+    report.clauseCount   = solver.getClauseCount();
+    report.conflictCount = solver.getConflictCount();
+
+    switch (result) {
+      case SatSolver::Result::Unsatisfiable:
+        report.result = Result::Equivalent;
+        break;
+      case SatSolver::Result::Satisfiable: {
+        std::vector<u8> vector(inputCount);
+        for (usize i = 0; i < inputCount; ++i) {
+          vector[i] = u8(solver.getValue(SatSolver::variableOf(inputs[i])));
+        }
+        const bool different = setCounterexample(a, b, std::move(vector), report);
+        GATE_ASSERT_WITH_MESSAGE(different, "the counterexample doesn't differ in simulation");
+        report.result = Result::Different;
+        break;
+      }
+      case SatSolver::Result::Unknown:
+        break;
+    }
+    return report;
+  }
+
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "Core/Base.hpp"
+#include "Simulation/Netlist.hpp"
+
+#include <vector>
+
+namespace Gate::Simulation {
+
+  // Checks that two netlists with the same number of inputs and outputs compute the same
+  // outputs for every input vector, each vector being evaluated from the power on state as
+  // with Engine::simulate().
+  //
+  // Netlists with few inputs are simulated exhaustively, which is a proof. Otherwise random
+  // vectors are simulated first, since most differences show up quickly, and then the outputs
+  // of both netlists are compared with a SAT solver: a vector for which one output differs
+  // (the miter) is a counterexample, and if there is none the netlists are equivalent. Both
+  // netlists are encoded together with structural hashing, so the logic they share is only
+  // encoded once.
+  //
+  // The value of a feedback loop depends on how it is iterated, it can't be encoded, so
+  // netlists with loops that are too big to simulate exhaustively are only screened. So are
+  // netlists with memories, their reads would be encoded as a multiplexer of every word.
+  class EquivalenceChecker {
+  public:
+    enum class Result : u8 {
+      Equivalent,
+      Different,
+
+      // No difference was found, but it couldn't be proved.
+      Unknown,
+    };
+
+    enum class Method : u8 {
+      Exhaustive,
+      Random,
+      Sat,
+    };
+
+    // Netlists with up to this many inputs are simulated exhaustively.
+    static const constexpr u32 EXHAUSTIVE_INPUTS = 20;
+
+    struct Options {
+      u64 seed = 1;
+      u64 randomVectors = u64(1) << 16;
+
+      // Conflicts before the proof gives up, 0 is no limit.
+      u64 conflictLimit = u64(1) << 22;
+    };
+
+    struct Report {
+      Result result = Result::Unknown;
+
+      // How the result was found.
+      Method method = Method::Random;
+      u64 vectorCount = 0;
+
+      // Input values of a vector for which the outputs differ, and the outputs of both netlists.
+      std::vector<u8> counterexample;
+      std::vector<u8> outputsA;
+      std::vector<u8> outputsB;
+
+      u32 variableCount = 0;
+      u32 clauseCount = 0;
+      u64 conflictCount = 0;
+    };
+
+  public:
+    static Report check(const Netlist& a, const Netlist& b, const Options& options);
+  };
+
+}
@@ -0,0 +1,201 @@
+#include "Simulation/Fault.hpp"
+#include "Simulation/Engine.hpp"
+#include "Core/ThreadPool.hpp"
+
+#include <algorithm>
+
+namespace Gate::Simulation {
+
+  namespace {
+    // Evaluates a netlist with a different fault in every lane, the faults are injected
+    // every time their net is written.
+    struct Evaluator {
+      const Netlist& netlist;
+      std::vector<u64> values;
+      std::vector<u64> stuckLow;
+      std::vector<u64> stuckHigh;
+      std::vector<u64> loopValues;
+
+      inline void write(NetId net, u64 value) {
+        values[net] = (value | stuckHigh[net]) & ~stuckLow[net];
+      }
+
+      u64 compute(const Instruction& instruction) const {
+        const u64* words = values.data();
+        switch (instruction.opcode) {
+          case Opcode::And:    return words[instruction.a] & words[instruction.b];
+          case Opcode::Or:     return words[instruction.a] | words[instruction.b];
+          case Opcode::Xor:    return words[instruction.a] ^ words[instruction.b];
+          case Opcode::Not:    return ~words[instruction.a];
+          case Opcode::Buffer: return words[instruction.a];
+          case Opcode::Merge: {
+            const NetId* operands = netlist.getOperands().data() + instruction.a;
+            u64 value = 0;
+            for (u32 i = 0; i < instruction.b; ++i) {
+              value |= words[operands[i]];
+            }
+            return value;
+          }
+          case Opcode::Lookup: {
+            // The lanes have different inputs, they are gathered one at a time.
+            auto& lookup = netlist.getLookups()[instruction.a];
+            u32 indexes[64] = {};
+            for (u32 i = 0; i < lookup.inputs.size(); ++i) {
+              const u64 word = words[lookup.inputs[i]];
+              for (u32 lane = 0; lane < 64; ++lane) {
+                indexes[lane] |= u32((word >> lane) & 1) << i;
+              }
+            }
+            u64 value = 0;
+            for (u32 lane = 0; lane < 64; ++lane) {
+              value |= u64(lookup.table->get(instruction.b, indexes[lane])) << lane;
+            }
+            return value;
+          }
+          case Opcode::Read: {
+            // Memories are never written, they keep their contents at power on.
+            auto& memory = netlist.getMemories()[instruction.a];
+            u32 indexes[64] = {};
+            for (u32 i = 0; i < memory.address.size(); ++i) {
+              const u64 word = words[memory.address[i]];
+              for (u32 lane = 0; lane < 64; ++lane) {
+                indexes[lane] |= u32((word >> lane) & 1) << i;
+              }
+            }
+            u64 value = 0;
+            for (u32 lane = 0; lane < 64; ++lane) {
+              value |= ((memory.getInitialWord(indexes[lane]) >> instruction.b) & 1) << lane;
+            }
+            return value;
+          }
+        }
+        GATE_UNREACHABLE("unknown opcode");
+      }
+
+      // Same iteration as Engine::executeLoop(), from the current values.
+      void loop(const Loop& loop) {
+        auto& instructions = netlist.getInstructions();
+        const u32 maxIterations = Engine::LOOP_ITERATION_FACTOR * (loop.end - loop.begin) + 1;
+        for (u32 iteration = 0; iteration < maxIterations; ++iteration) {
+          loopValues.clear();
+          for (u32 i = loop.begin; i < loop.end; ++i) {
+            loopValues.push_back(values[instructions[i].output]);
+          }
+          bool changed = false;
+          for (u32 i = loop.begin; i < loop.end; ++i) {
+            write(instructions[i].output, compute(instructions[i]));
+            changed |= values[instructions[i].output] != loopValues[i - loop.begin];
+          }
+          if (!changed) {
+            return;
+          }
+        }
+      }
+
+      void run() {
+        auto& instructions = netlist.getInstructions();
+        auto& loops = netlist.getLoops();
+        u32 next = 0;
+        for (u32 i = 0; i < instructions.size();) {
+          if (next < loops.size() && loops[next].begin == i) {
+            loop(loops[next]);
+            i = loops[next++].end;
+            continue;
+          }
+          write(instructions[i].output, compute(instructions[i]));
+          i++;
+        }
+      }
+    };
+  }
+
+  std::vector<FaultSimulator::Fault> FaultSimulator::enumerate(const Netlist& netlist) {
+    std::vector<u8> driven(netlist.getNetCount(), 0);
+    for (auto net : netlist.getInputs()) {
+      driven[net] = 1;
+    }
+    for (auto& instruction : netlist.getInstructions()) {
+      driven[instruction.output] = 1;
+    }
+    for (auto& reg : netlist.getRegisters()) {
+      driven[reg.q] = 1;
+    }
+
+    std::vector<Fault> faults;
+    for (NetId net = 0; net < netlist.getNetCount(); ++net) {
+      if (driven[net]) {
+        faults.push_back(Fault{net, false});
+        faults.push_back(Fault{net, true});
+      }
+    }
+    return faults;
+  }
+
+  FaultSimulator::Report FaultSimulator::simulate(const Netlist& netlist, std::vector<Fault> faults, Slice<const u64> inputs, usize vectorCount) {
+    auto& netlistInputs  = netlist.getInputs();
+    auto& netlistOutputs = netlist.getOutputs();
+    const usize inputCount  = netlistInputs.size();
+    const usize outputCount = netlistOutputs.size();
+    GATE_ASSERT(inputCount == 0 || inputs.size() >= (vectorCount + 63) / 64 * inputCount);
+
+    Report report;
+    report.faults = std::move(faults);
+    report.detectedBy.assign(report.faults.size(), NOT_DETECTED);
+
+    // The expected outputs come from the normal engine, 64 vectors at a time.
+    Engine engine;
+    engine.load(netlist);
+    const auto expected = engine.simulate(Slice<const u64>(inputs.data(), (vectorCount + 63) / 64 * inputCount));
+
+    const u32 batchCount = u32((report.faults.size() + 63) / 64);
+    ThreadPool::get().parallelFor(batchCount, 1, [&](u32 begin, u32 end) {
+      const u32 netCount = netlist.getNetCount();
+      Evaluator evaluator{netlist, {}, std::vector<u64>(netCount, 0), std::vector<u64>(netCount, 0), {}};
+      for (u32 batch = begin; batch < end; ++batch) {
+        const usize first = usize(batch) * 64;
+        const u32 laneCount = (u32)std::min<usize>(64, report.faults.size() - first);
+        std::fill(evaluator.stuckLow.begin(), evaluator.stuckLow.end(), 0);
+        std::fill(evaluator.stuckHigh.begin(), evaluator.stuckHigh.end(), 0);
+        for (u32 lane = 0; lane < laneCount; ++lane) {
+          auto& fault = report.faults[first + lane];
+          (fault.value ? evaluator.stuckHigh : evaluator.stuckLow)[fault.net] |= u64(1) << lane;
+        }
+
+        // Faults are dropped once detected, the batch stops when all of them are.
+        const u64 lanes = laneCount == 64 ? ~u64(0) : (u64(1) << laneCount) - 1;
+        u64 detected = 0;
+        for (usize vector = 0; vector < vectorCount && detected != lanes; ++vector) {
+          evaluator.values.assign(netCount, 0);
+          const u64* vectorInputs = inputs.data() + (vector / 64) * inputCount;
+          for (usize i = 0; i < inputCount; ++i) {
+            evaluator.write(netlistInputs[i], (vectorInputs[i] >> (vector % 64)) & 1 ? ~u64(0) : 0);
+          }
+          // Registers hold their reset value, as in a freshly loaded engine.
+          for (auto& reg : netlist.getRegisters()) {
+            evaluator.write(reg.q, 0);
+          }
+          evaluator.run();
+
+          u64 difference = 0;
+          for (usize i = 0; i < outputCount; ++i) {
+            const u64 value = (expected[(vector / 64) * outputCount + i] >> (vector % 64)) & 1 ? ~u64(0) : 0;
+            difference |= evaluator.values[netlistOutputs[i]] ^ value;
+          }
+          difference &= lanes & ~detected;
+          detected |= difference;
+          for (u32 lane = 0; difference != 0 && lane < laneCount; ++lane) {
+            if ((difference >> lane) & 1) {
+              report.detectedBy[first + lane] = (u32)vector;
+            }
+          }
+        }
+      }
+    });
+
+    report.detectedCount = (u32)std::count_if(report.detectedBy.begin(), report.detectedBy.end(), [](u32 vector) {
+      return vector != NOT_DETECTED;
+    });
+    return report;
+  }
+
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Core/Base.hpp"
+#include "Simulation/Netlist.hpp"
+
+#include <vector>
+
+namespace Gate::Simulation {
+
+  // Stuck-at fault simulation, a faulty net keeps the same value whatever drives it.
+  //
+  // Every lane of a word simulates the netlist with a different fault, so 64 faults are simulated
+  // at once, and the batches of faults are spread over the thread pool. A fault is detected by a
+  // vector when an output differs from the fault free netlist. Like with Engine::simulate(), every
+  // vector is evaluated from the power on state.
+  class FaultSimulator {
+  public:
+    static const constexpr u32 NOT_DETECTED = UINT32_MAX;
+
+    struct Fault {
+      NetId net;
+      bool value;
+    };
+
+    struct Report {
+      std::vector<Fault> faults;
+
+      // Index of the first vector that detects each fault, or NOT_DETECTED.
+      std::vector<u32> detectedBy;
+      u32 detectedCount = 0;
+
+      inline f64 getCoverage() const { return faults.empty() ? 1.0 : f64(detectedCount) / f64(faults.size()); }
+    };
+
+  public:
+    // Both faults of every input, register and net driven by an instruction.
+    static std::vector<Fault> enumerate(const Netlist& netlist);
+
+    // The vectors are laid out as for Engine::simulate(), in batches of 64 with one word per
+    // input, the lanes past vectorCount are ignored.
+    static Report simulate(const Netlist& netlist, std::vector<Fault> faults, Slice<const u64> inputs, usize vectorCount);
+  };
+
+}
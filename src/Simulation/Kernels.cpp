@@ -0,0 +1,244 @@
+#include "Simulation/Kernels.hpp"
+
+#if defined(GATE_PLATFORM_NATIVE) && (defined(__x86_64__) || defined(_M_X64))
+# define GATE_SIMULATION_X86 1
+# include <immintrin.h>
+# if defined(_MSC_VER)
+#   include <intrin.h>
+#   define GATE_TARGET_AVX2
+# else
+#   define GATE_TARGET_AVX2 __attribute__((target("avx2")))
+# endif
+#endif
+
+namespace Gate::Simulation {
+
+  namespace {
+
+    struct AndOperation {
+      static const constexpr bool unary = false;
+      static inline u64 apply(u64 a, u64 b) { return a & b; }
+#ifdef GATE_SIMULATION_X86
+      static inline __m128i apply(__m128i a, __m128i b) { return _mm_and_si128(a, b); }
+      GATE_TARGET_AVX2 static inline __m256i apply(__m256i a, __m256i b) { return _mm256_and_si256(a, b); }
+#endif
+    };
+
+    struct OrOperation {
+      static const constexpr bool unary = false;
+      static inline u64 apply(u64 a, u64 b) { return a | b; }
+#ifdef GATE_SIMULATION_X86
+      static inline __m128i apply(__m128i a, __m128i b) { return _mm_or_si128(a, b); }
+      GATE_TARGET_AVX2 static inline __m256i apply(__m256i a, __m256i b) { return _mm256_or_si256(a, b); }
+#endif
+    };
+
+    struct XorOperation {
+      static const constexpr bool unary = false;
+      static inline u64 apply(u64 a, u64 b) { return a ^ b; }
+#ifdef GATE_SIMULATION_X86
+      static inline __m128i apply(__m128i a, __m128i b) { return _mm_xor_si128(a, b); }
+      GATE_TARGET_AVX2 static inline __m256i apply(__m256i a, __m256i b) { return _mm256_xor_si256(a, b); }
+#endif
+    };
+
+    struct NotOperation {
+      static const constexpr bool unary = true;
+      static inline u64 apply(u64 a, u64) { return ~a; }
+#ifdef GATE_SIMULATION_X86
+      static inline __m128i apply(__m128i a, __m128i) { return _mm_xor_si128(a, _mm_set1_epi64x(-1)); }
+      GATE_TARGET_AVX2 static inline __m256i apply(__m256i a, __m256i) { return _mm256_xor_si256(a, _mm256_set1_epi64x(-1)); }
+#endif
+    };
+
+    struct BufferOperation {
+      static const constexpr bool unary = true;
+      static inline u64 apply(u64 a, u64) { return a; }
+#ifdef GATE_SIMULATION_X86
+      static inline __m128i apply(__m128i a, __m128i) { return a; }
+      GATE_TARGET_AVX2 static inline __m256i apply(__m256i a, __m256i) { return a; }
+#endif
+    };
+
+    template<typename Operation>
+    void scalarKernel(u64* words, usize stride, const NetId* a, const NetId* b, const NetId* outputs, u32 count) {
+      if (stride == 1) {
+        for (u32 i = 0; i < count; ++i) {
+          words[outputs[i]] = Operation::apply(words[a[i]], words[b[i]]);
+        }
+        return;
+      }
+      for (u32 i = 0; i < count; ++i) {
+        const u64* x = words + usize(a[i]) * stride;
+        const u64* y = words + usize(b[i]) * stride;
+        u64* z = words + usize(outputs[i]) * stride;
+        for (usize j = 0; j < stride; ++j) {
+          z[j] = Operation::apply(x[j], y[j]);
+        }
+      }
+    }
+
+#ifdef GATE_SIMULATION_X86
+    template<typename Operation>
+    void sse2Kernel(u64* words, usize stride, const NetId* a, const NetId* b, const NetId* outputs, u32 count) {
+      // There are no gathers, single word nets are faster with the scalar kernel.
+      if (stride == 1) {
+        scalarKernel<Operation>(words, stride, a, b, outputs, count);
+        return;
+      }
+      for (u32 i = 0; i < count; ++i) {
+        const u64* x = words + usize(a[i]) * stride;
+        const u64* y = words + usize(b[i]) * stride;
+        u64* z = words + usize(outputs[i]) * stride;
+        usize j = 0;
+        for (; j + 2 <= stride; j += 2) {
+          __m128i xv = _mm_loadu_si128((const __m128i*)(x + j));
+          __m128i yv = Operation::unary ? xv : _mm_loadu_si128((const __m128i*)(y + j));
+          _mm_storeu_si128((__m128i*)(z + j), Operation::apply(xv, yv));
+        }
+        for (; j < stride; ++j) {
+          z[j] = Operation::apply(x[j], y[j]);
+        }
+      }
+    }
+
+    template<typename Operation>
+    GATE_TARGET_AVX2 void avx2Kernel(u64* words, usize stride, const NetId* a, const NetId* b, const NetId* outputs, u32 count) {
+      if (stride == 1) {
+        // Gather the inputs of four gates and compute them at once.
+        u32 i = 0;
+        for (; i + 4 <= count; i += 4) {
+          __m128i ai = _mm_loadu_si128((const __m128i*)(a + i));
+          __m256i xv = _mm256_i32gather_epi64((const long long*)words, ai, 8);
+          __m256i yv = xv;
+          if constexpr (!Operation::unary) {
+            __m128i bi = _mm_loadu_si128((const __m128i*)(b + i));
+            yv = _mm256_i32gather_epi64((const long long*)words, bi, 8);
+          }
+          alignas(32) u64 result[4];
+          _mm256_store_si256((__m256i*)result, Operation::apply(xv, yv));
+          words[outputs[i + 0]] = result[0];
+          words[outputs[i + 1]] = result[1];
+          words[outputs[i + 2]] = result[2];
+          words[outputs[i + 3]] = result[3];
+        }
+        for (; i < count; ++i) {
+          words[outputs[i]] = Operation::apply(words[a[i]], words[b[i]]);
+        }
+        return;
+      }
+      for (u32 i = 0; i < count; ++i) {
+        const u64* x = words + usize(a[i]) * stride;
+        const u64* y = words + usize(b[i]) * stride;
+        u64* z = words + usize(outputs[i]) * stride;
+        usize j = 0;
+        for (; j + 4 <= stride; j += 4) {
+          __m256i xv = _mm256_loadu_si256((const __m256i*)(x + j));
+          __m256i yv = Operation::unary ? xv : _mm256_loadu_si256((const __m256i*)(y + j));
+          _mm256_storeu_si256((__m256i*)(z + j), Operation::apply(xv, yv));
+        }
+        for (; j + 2 <= stride; j += 2) {
+          __m128i xv = _mm_loadu_si128((const __m128i*)(x + j));
+          __m128i yv = Operation::unary ? xv : _mm_loadu_si128((const __m128i*)(y + j));
+          _mm_storeu_si128((__m128i*)(z + j), Operation::apply(xv, yv));
+        }
+        for (; j < stride; ++j) {
+          z[j] = Operation::apply(x[j], y[j]);
+        }
+      }
+    }
+#endif
+
+    // Indexed by opcode, from And up to Buffer.
+    const Kernel sScalarKernels[] = {
+      scalarKernel<AndOperation>,
+      scalarKernel<OrOperation>,
+      scalarKernel<XorOperation>,
+      scalarKernel<NotOperation>,
+      scalarKernel<BufferOperation>,
+    };
+#ifdef GATE_SIMULATION_X86
+    const Kernel sSse2Kernels[] = {
+      sse2Kernel<AndOperation>,
+      sse2Kernel<OrOperation>,
+      sse2Kernel<XorOperation>,
+      sse2Kernel<NotOperation>,
+      sse2Kernel<BufferOperation>,
+    };
+    const Kernel sAvx2Kernels[] = {
+      avx2Kernel<AndOperation>,
+      avx2Kernel<OrOperation>,
+      avx2Kernel<XorOperation>,
+      avx2Kernel<NotOperation>,
+      avx2Kernel<BufferOperation>,
+    };
+#endif
+
+    InstructionSet detectInstructionSet() {
+#ifdef GATE_SIMULATION_X86
+# if defined(_MSC_VER)
+      int info[4];
+      __cpuid(info, 0);
+      if (info[0] >= 7) {
+        __cpuid(info, 1);
+        bool osxsave = (info[2] & (1 << 27)) != 0;
+        __cpuidex(info, 7, 0);
+        bool avx2 = (info[1] & (1 << 5)) != 0;
+        if (osxsave && avx2 && (_xgetbv(0) & 0x6) == 0x6) {
+          return InstructionSet::Avx2;
+        }
+      }
+# else
+      __builtin_cpu_init();
+      if (__builtin_cpu_supports("avx2")) {
+        return InstructionSet::Avx2;
+      }
+# endif
+      // SSE2 is part of the x86-64 baseline.
+      return InstructionSet::Sse2;
+#else
+      return InstructionSet::Scalar;
+#endif
+    }
+
+    InstructionSet sSupportedInstructionSet = detectInstructionSet();
+    InstructionSet sInstructionSet          = sSupportedInstructionSet;
+
+  }
+
+  Kernel Kernels::get(Opcode opcode) {
+    GATE_DEBUG_ASSERT_WITH_MESSAGE(u8(opcode) <= u8(Opcode::Buffer), "only gates have kernels");
+    switch (sInstructionSet) {
+#ifdef GATE_SIMULATION_X86
+      case InstructionSet::Avx2: return sAvx2Kernels[u8(opcode)];
+      case InstructionSet::Sse2: return sSse2Kernels[u8(opcode)];
+#endif
+      default:
+        break;
+    }
+    return sScalarKernels[u8(opcode)];
+  }
+
+  InstructionSet Kernels::getSupportedInstructionSet() {
+    return sSupportedInstructionSet;
+  }
+  InstructionSet Kernels::getInstructionSet() {
+    return sInstructionSet;
+  }
+  void Kernels::setInstructionSet(InstructionSet instructionSet) {
+    if (u8(instructionSet) > u8(sSupportedInstructionSet)) {
+      instructionSet = sSupportedInstructionSet;
+    }
+    sInstructionSet = instructionSet;
+  }
+
+  const char* Kernels::toString(InstructionSet instructionSet) {
+    switch (instructionSet) {
+      case InstructionSet::Scalar: return "scalar";
+      case InstructionSet::Sse2:   return "sse2";
+      case InstructionSet::Avx2:   return "avx2";
+    }
+    GATE_UNREACHABLE("invalid instruction set");
+  }
+
+}
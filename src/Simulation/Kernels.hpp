@@ -0,0 +1,31 @@
+#pragma once
+
+#include "Core/Base.hpp"
+#include "Simulation/Netlist.hpp"
+
+namespace Gate::Simulation {
+
+  enum class InstructionSet : u8 {
+    Scalar,
+    Sse2,
+    Avx2,
+  };
+
+  // Evaluates count gates of the same type, every net owns stride consecutive words.
+  using Kernel = void(*)(u64* words, usize stride, const NetId* a, const NetId* b, const NetId* outputs, u32 count);
+
+  class Kernels {
+  public:
+    // Returns the kernel of a gate opcode (And, Or, Xor, Not or Buffer).
+    static Kernel get(Opcode opcode);
+
+    static InstructionSet getSupportedInstructionSet();
+    static InstructionSet getInstructionSet();
+
+    // Selects the kernels, clamped to what the CPU supports.
+    static void setInstructionSet(InstructionSet instructionSet);
+
+    static const char* toString(InstructionSet instructionSet);
+  };
+
+}
@@ -0,0 +1,334 @@
+#include "Simulation/Native.hpp"
+#include "Simulation/Engine.hpp"
+
+#include <cstdarg>
+
+#if defined(GATE_PLATFORM_WEB)
+  // Dynamic libraries are not supported.
+#elif defined(_WIN32)
+# define WIN32_LEAN_AND_MEAN
+# define NOMINMAX
+# include <windows.h>
+#else
+# include <dlfcn.h>
+#endif
+
+namespace Gate::Simulation {
+
+  namespace {
+    void append(String& source, const char* format, ...) {
+      char buffer[256];
+      va_list args;
+      va_start(args, format);
+      int length = vsnprintf(buffer, sizeof(buffer), format, args);
+      va_end(args);
+      GATE_ASSERT(length >= 0 && length < (int)sizeof(buffer));
+      source.append(buffer, (usize)length);
+    }
+
+    // Nets are kept in locals while a word is evaluated, they are loaded on first use.
+    struct Generator {
+      const Netlist& netlist;
+      String& source;
+      std::vector<bool> declared;
+      std::vector<NetId> driven;
+
+      // Lookups that share a truth table also share its array.
+      std::unordered_map<const TruthTable*, u32> tables;
+
+      void load(NetId net) {
+        if (!declared[net]) {
+          declared[net] = true;
+          append(source, "    const uint64_t n%u = w[%u * stride];\n", net, net);
+        }
+      }
+
+      void loadOperands(const Instruction& instruction) {
+        switch (instruction.opcode) {
+          case Opcode::And:
+          case Opcode::Or:
+          case Opcode::Xor:
+            load(instruction.a);
+            load(instruction.b);
+            break;
+          case Opcode::Not:
+          case Opcode::Buffer:
+            load(instruction.a);
+            break;
+          case Opcode::Merge:
+            for (u32 i = 0; i < instruction.b; ++i) {
+              load(netlist.getOperands()[instruction.a + i]);
+            }
+            break;
+          case Opcode::Lookup:
+            for (auto net : netlist.getLookups()[instruction.a].inputs) {
+              load(net);
+            }
+            break;
+          default:
+            GATE_UNREACHABLE("unknown opcode");
+        }
+      }
+
+      void expression(const Instruction& instruction) {
+        switch (instruction.opcode) {
+          case Opcode::And:    append(source, "n%u & n%u", instruction.a, instruction.b); break;
+          case Opcode::Or:     append(source, "n%u | n%u", instruction.a, instruction.b); break;
+          case Opcode::Xor:    append(source, "n%u ^ n%u", instruction.a, instruction.b); break;
+          case Opcode::Not:    append(source, "~n%u", instruction.a); break;
+          case Opcode::Buffer: append(source, "n%u", instruction.a); break;
+          case Opcode::Merge:
+            if (instruction.b == 0) {
+              source += "0";
+            }
+            for (u32 i = 0; i < instruction.b; ++i) {
+              append(source, i == 0 ? "n%u" : " | n%u", netlist.getOperands()[instruction.a + i]);
+            }
+            break;
+          case Opcode::Lookup: {
+            auto& lookup = netlist.getLookups()[instruction.a];
+            append(source, "gate_lookup(table%u + %zu, {", tables.at(lookup.table.get()), instruction.b * lookup.table->getWordCount());
+            for (u32 i = 0; i < lookup.inputs.size(); ++i) {
+              append(source, i == 0 ? "n%u" : ", n%u", lookup.inputs[i]);
+            }
+            source += "})";
+          } break;
+          default:
+            GATE_UNREACHABLE("unknown opcode");
+        }
+      }
+
+      void instruction(const Instruction& instruction) {
+        loadOperands(instruction);
+        append(source, "    const uint64_t n%u = ", instruction.output);
+        expression(instruction);
+        source += ";\n";
+        declared[instruction.output] = true;
+        driven.push_back(instruction.output);
+      }
+
+      void table(const TruthTable& table) {
+        if (tables.count(&table)) {
+          return;
+        }
+        u32 index = (u32)tables.size();
+        tables[&table] = index;
+        append(source, "static const uint64_t table%u[] = {", index);
+        for (usize i = 0; i < table.words.size(); ++i) {
+          if (i % 4 == 0) {
+            source += "\n ";
+          }
+          append(source, " UINT64_C(0x%016llx),", (unsigned long long)table.words[i]);
+        }
+        source += "\n};\n\n";
+      }
+
+      // Same iteration as Engine::executeLoop(), the outputs start from their stored values.
+      void loop(u32 index, const Loop& loop) {
+        auto& instructions = netlist.getInstructions();
+        for (u32 i = loop.begin; i < loop.end; ++i) {
+          auto output = instructions[i].output;
+          declared[output] = true;
+          driven.push_back(output);
+          append(source, "    uint64_t n%u = w[%u * stride];\n", output, output);
+        }
+        for (u32 i = loop.begin; i < loop.end; ++i) {
+          loadOperands(instructions[i]);
+        }
+
+        const u32 maxIterations = Engine::LOOP_ITERATION_FACTOR * (loop.end - loop.begin) + 1;
+        append(source, "    for (uint32_t iteration = 0;; ++iteration) {\n");
+        append(source, "      if (iteration == %u) { oscillating[%u] = 1; break; }\n", maxIterations, index);
+        for (u32 i = loop.begin; i < loop.end; ++i) {
+          append(source, "      const uint64_t p%u = n%u;\n", i - loop.begin, instructions[i].output);
+        }
+        for (u32 i = loop.begin; i < loop.end; ++i) {
+          append(source, "      n%u = ", instructions[i].output);
+          expression(instructions[i]);
+          source += ";\n";
+        }
+        source += "      if (";
+        for (u32 i = loop.begin; i < loop.end; ++i) {
+          append(source, i == loop.begin ? "n%u == p%u" : " && n%u == p%u", instructions[i].output, i - loop.begin);
+        }
+        source += ") break;\n";
+        source += "    }\n";
+      }
+    };
+  }
+
+  bool NativeModule::generate(const Netlist& netlist, String& source) {
+    auto& instructions = netlist.getInstructions();
+    if (!netlist.getMemories().empty()) {
+      Logger::error("Native: netlists with memories can't be generated");
+      return false;
+    }
+
+    source.clear();
+    source += "// Generated by gate, do not edit.\n";
+    source += "#include <stddef.h>\n";
+    source += "#include <stdint.h>\n\n";
+    source += "#if defined(_WIN32)\n";
+    source += "# define GATE_EXPORT extern \"C\" __declspec(dllexport)\n";
+    source += "#else\n";
+    source += "# define GATE_EXPORT extern \"C\" __attribute__((visibility(\"default\")))\n";
+    source += "#endif\n\n";
+    append(source, "GATE_EXPORT uint32_t gate_abi_version() { return %u; }\n", ABI_VERSION);
+    append(source, "GATE_EXPORT uint64_t gate_fingerprint() { return UINT64_C(%llu); }\n\n", (unsigned long long)fingerprint(netlist));
+
+    Generator generator{netlist, source, std::vector<bool>(netlist.getNetCount(), false), {}, {}};
+    if (!netlist.getLookups().empty()) {
+      source += "template<uint32_t N>\n";
+      source += "static uint64_t gate_lookup(const uint64_t* table, const uint64_t (&inputs)[N]) {\n";
+      source += "  uint64_t result = 0;\n";
+      source += "  for (uint32_t lane = 0; lane < 64; ++lane) {\n";
+      source += "    uint32_t index = 0;\n";
+      source += "    for (uint32_t i = 0; i < N; ++i) index |= uint32_t((inputs[i] >> lane) & 1) << i;\n";
+      source += "    result |= ((table[index / 64] >> (index % 64)) & 1) << lane;\n";
+      source += "  }\n";
+      source += "  return result;\n";
+      source += "}\n\n";
+      for (auto& lookup : netlist.getLookups()) {
+        generator.table(*lookup.table);
+      }
+    }
+
+    source += "GATE_EXPORT void gate_evaluate(uint64_t* words, size_t stride, uint8_t* oscillating) {\n";
+    source += "  (void)oscillating;\n";
+    source += "  for (size_t k = 0; k < stride; ++k) {\n";
+    source += "    uint64_t* w = words + k;\n";
+    auto& loops = netlist.getLoops();
+    u32 loop = 0;
+    for (u32 i = 0; i < instructions.size();) {
+      if (loop < loops.size() && loops[loop].begin == i) {
+        generator.loop(loop, loops[loop]);
+        i = loops[loop++].end;
+        continue;
+      }
+      generator.instruction(instructions[i++]);
+    }
+
+    for (auto net : generator.driven) {
+      append(source, "    w[%u * stride] = n%u;\n", net, net);
+    }
+    source += "  }\n";
+    source += "}\n";
+    return true;
+  }
+
+  u64 NativeModule::fingerprint(const Netlist& netlist) {
+    // FNV-1a
+    u64 hash = 0xcbf29ce484222325;
+    auto mix = [&hash](u64 value) {
+      for (u32 i = 0; i < 8; ++i) {
+        hash ^= (value >> (i * 8)) & 0xFF;
+        hash *= 0x100000001b3;
+      }
+    };
+
+    mix(ABI_VERSION);
+    mix(netlist.getNetCount());
+    for (auto& instruction : netlist.getInstructions()) {
+      mix(u64(instruction.opcode));
+      mix(instruction.a);
+      mix(instruction.b);
+      mix(instruction.output);
+    }
+    for (auto operand : netlist.getOperands()) {
+      mix(operand);
+    }
+    for (auto& loop : netlist.getLoops()) {
+      mix(loop.begin);
+      mix(loop.end);
+    }
+    for (auto& lookup : netlist.getLookups()) {
+      for (auto net : lookup.inputs) {
+        mix(net);
+      }
+      for (auto word : lookup.table->words) {
+        mix(word);
+      }
+    }
+    for (auto& reg : netlist.getRegisters()) {
+      mix(reg.d);
+      mix(reg.clock);
+      mix(reg.q);
+    }
+    for (auto& memory : netlist.getMemories()) {
+      mix(memory.dataWidth);
+      for (auto net : memory.address) {
+        mix(net);
+      }
+      for (auto net : memory.data) {
+        mix(net);
+      }
+      mix(memory.write);
+      mix(memory.clock);
+    }
+    return hash;
+  }
+
+#if defined(GATE_PLATFORM_WEB)
+
+  NativeModule::Handle NativeModule::load(const String& path, const Netlist&) {
+    Logger::error("Native: can't load '%s', native modules are not supported on the web", path.c_str());
+    return nullptr;
+  }
+
+  NativeModule::~NativeModule() {}
+
+#else
+
+  namespace {
+#if defined(_WIN32)
+    void* openLibrary(const String& path) { return (void*)LoadLibraryA(path.c_str()); }
+    void* findSymbol(void* library, const char* name) { return (void*)GetProcAddress((HMODULE)library, name); }
+    void closeLibrary(void* library) { FreeLibrary((HMODULE)library); }
+    const char* libraryError() { return "LoadLibrary failed"; }
+#else
+    void* openLibrary(const String& path) { return dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL); }
+    void* findSymbol(void* library, const char* name) { return dlsym(library, name); }
+    void closeLibrary(void* library) { dlclose(library); }
+    const char* libraryError() { return dlerror(); }
+#endif
+  }
+
+  NativeModule::Handle NativeModule::load(const String& path, const Netlist& netlist) {
+    void* library = openLibrary(path);
+    if (!library) {
+      Logger::error("Native: couldn't load '%s': %s", path.c_str(), libraryError());
+      return nullptr;
+    }
+
+    auto abiVersion  = (u32(*)())findSymbol(library, "gate_abi_version");
+    auto fingerprint = (u64(*)())findSymbol(library, "gate_fingerprint");
+    auto evaluate    = (EvaluateFunction)findSymbol(library, "gate_evaluate");
+    if (!abiVersion || !fingerprint || !evaluate) {
+      Logger::error("Native: '%s' is not a generated module", path.c_str());
+      closeLibrary(library);
+      return nullptr;
+    }
+    if (abiVersion() != ABI_VERSION) {
+      Logger::error("Native: '%s' has version %u, expected %u", path.c_str(), abiVersion(), ABI_VERSION);
+      closeLibrary(library);
+      return nullptr;
+    }
+    if (fingerprint() != NativeModule::fingerprint(netlist)) {
+      Logger::error("Native: '%s' was generated from a different netlist", path.c_str());
+      closeLibrary(library);
+      return nullptr;
+    }
+    return std::make_shared<NativeModule>(library, evaluate);
+  }
+
+  NativeModule::~NativeModule() {
+    closeLibrary(mLibrary);
+  }
+
+#endif
+
+  NativeModule::NativeModule(void* library, EvaluateFunction function)
+    : mLibrary{library}, mEvaluate{function}
+  {}
+
+}
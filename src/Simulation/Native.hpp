@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Core/Base.hpp"
+#include "Simulation/Netlist.hpp"
+
+namespace Gate::Simulation {
+
+  // Straight-line C++ evaluator of a netlist, an alternative to interpreting it
+  // for big designs that don't change.
+  //
+  // The generated translation unit exports a single function with the same semantics
+  // as Engine::execute(), registers are read like inputs. It has to be compiled into a
+  // shared library, e.g.:
+  //
+  //   c++ -O2 -shared -fPIC chip.cpp -o chip.so
+  class NativeModule {
+  public:
+    using Handle = Ref<NativeModule>;
+    using EvaluateFunction = void(*)(u64* words, usize stride, u8* oscillating);
+
+    // Bumped whenever the interface of the generated code changes.
+    static const constexpr u32 ABI_VERSION = 1;
+
+  public:
+    // Fails for netlists with memories, they can't be expressed in the generated code.
+    static bool generate(const Netlist& netlist, String& source);
+
+    // Loads a compiled module, it is rejected if it was generated from a different netlist.
+    static Handle load(const String& path, const Netlist& netlist);
+
+    // Identifies the structure of a netlist, not its values.
+    static u64 fingerprint(const Netlist& netlist);
+
+  public:
+    NativeModule(void* library, EvaluateFunction function);
+    ~NativeModule();
+    DISALLOW_MOVE_AND_COPY(NativeModule);
+
+    inline void evaluate(u64* words, usize stride, u8* oscillating) const { mEvaluate(words, stride, oscillating); }
+
+  private:
+    void* mLibrary;
+    EvaluateFunction mEvaluate;
+  };
+
+}
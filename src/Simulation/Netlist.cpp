@@ -0,0 +1,515 @@
+#include "Simulation/Netlist.hpp"
+
+#include <algorithm>
+
+namespace Gate::Simulation {
+
+  static const constexpr u32 OPCODE_COUNT = u32(Opcode::Read) + 1;
+
+  u64 Memory::getInitialWord(u32 index) const {
+    return contents ? readWord(contents->data(), dataWidth, index) : 0;
+  }
+
+  std::vector<u8> Memory::getInitialContents() const {
+    return contents ? *contents : std::vector<u8>(getByteCount(), 0);
+  }
+
+  // A word spans at most 9 bytes, it is read and written a byte at a time.
+  u64 Memory::readWord(const u8* bytes, u32 dataWidth, u32 index) {
+    usize bit = usize(index) * dataWidth;
+    u64 value = 0;
+    for (u32 i = 0; i < dataWidth;) {
+      const u32 shift = bit % 8;
+      const u32 count = std::min(8 - shift, dataWidth - i);
+      value |= u64((bytes[bit / 8] >> shift) & ((1u << count) - 1)) << i;
+      i += count;
+      bit += count;
+    }
+    return value;
+  }
+
+  void Memory::writeWord(u8* bytes, u32 dataWidth, u32 index, u64 value) {
+    usize bit = usize(index) * dataWidth;
+    for (u32 i = 0; i < dataWidth;) {
+      const u32 shift = bit % 8;
+      const u32 count = std::min(8 - shift, dataWidth - i);
+      const u8 mask = u8(((1u << count) - 1) << shift);
+      bytes[bit / 8] = u8((bytes[bit / 8] & ~mask) | ((u32(value >> i) << shift) & mask));
+      i += count;
+      bit += count;
+    }
+  }
+
+  Netlist::Builder Netlist::builder() {
+    return Builder();
+  }
+
+  NetId Netlist::Builder::addNet() {
+    return mNetCount++;
+  }
+  NetId Netlist::Builder::addNets(u32 count) {
+    GATE_DEBUG_ASSERT(count > 0);
+    NetId first = mNetCount;
+    mNetCount += count;
+    return first;
+  }
+  void Netlist::Builder::addInput(NetId net) {
+    mInputs.push_back(net);
+  }
+  void Netlist::Builder::addOutput(NetId net) {
+    mOutputs.push_back(net);
+  }
+  void Netlist::Builder::addGate(Opcode opcode, NetId a, NetId b, NetId output) {
+    GATE_DEBUG_ASSERT(opcode != Opcode::Merge);
+    push(Node{opcode, 0, {a, b}, {output}, 0, 0});
+  }
+  void Netlist::Builder::addGate(Opcode opcode, NetId a, NetId output) {
+    GATE_DEBUG_ASSERT(opcode == Opcode::Not || opcode == Opcode::Buffer);
+    push(Node{opcode, 0, {a}, {output}, 0, 0});
+  }
+  void Netlist::Builder::addMerge(std::vector<NetId> inputs, NetId output) {
+    push(Node{Opcode::Merge, 0, std::move(inputs), {output}, 0, 0});
+  }
+
+  void Netlist::Builder::addLookup(Ref<const TruthTable> table, std::vector<NetId> inputs, std::vector<NetId> outputs) {
+    GATE_DEBUG_ASSERT(table->inputCount == inputs.size() && table->outputCount == outputs.size());
+    u32 lookup = (u32)mLookups.size();
+    mLookups.push_back(Lookup{std::move(table), inputs});
+    for (u32 i = 0; i < outputs.size(); ++i) {
+      push(Node{Opcode::Lookup, lookup, inputs, {outputs[i]}, i, 0});
+    }
+  }
+
+  void Netlist::Builder::addRegister(NetId d, NetId clock, NetId q) {
+    mRegisters.push_back(Register{d, clock, q, mDelay});
+  }
+
+  void Netlist::Builder::addMemory(Memory memory, std::vector<NetId> outputs) {
+    GATE_DEBUG_ASSERT(memory.address.size() <= Memory::MAX_ADDRESS_WIDTH && memory.dataWidth <= Memory::MAX_DATA_WIDTH);
+    GATE_DEBUG_ASSERT(outputs.size() == memory.dataWidth && (!memory.isWritable() || memory.data.size() == memory.dataWidth));
+    GATE_DEBUG_ASSERT(!memory.contents || memory.contents->size() == memory.getByteCount());
+    u32 index = (u32)mMemories.size();
+    std::vector<NetId> address = memory.address;
+    mMemories.push_back(std::move(memory));
+    for (u32 i = 0; i < outputs.size(); ++i) {
+      if (outputs[i] != NULL_NET) {
+        push(Node{Opcode::Read, index, address, {outputs[i]}, i, 0});
+      }
+    }
+  }
+
+  void Netlist::Builder::push(Node node) {
+    node.delay = mDelay;
+    mNodes.push_back(std::move(node));
+  }
+
+  Netlist Netlist::Builder::build() {
+    static const constexpr u32 NO_NODE = UINT32_MAX;
+
+    const u32 nodeCount = (u32)mNodes.size();
+
+    Netlist netlist;
+    netlist.mNetCount = mNetCount;
+    netlist.mInputs   = std::move(mInputs);
+    netlist.mOutputs  = std::move(mOutputs);
+    netlist.mLookups  = std::move(mLookups);
+    netlist.mRegisters = std::move(mRegisters);
+    netlist.mMemories  = std::move(mMemories);
+
+    // Driver and readers (in compressed rows) of every net.
+    std::vector<u32> drivers(mNetCount, NO_NODE);
+    std::vector<u32> readersOffsets(mNetCount + 1, 0);
+    for (u32 i = 0; i < nodeCount; ++i) {
+      for (auto net : mNodes[i].outputs) {
+        GATE_DEBUG_ASSERT_WITH_MESSAGE(drivers[net] == NO_NODE, "a net can only have one driver");
+        drivers[net] = i;
+      }
+      for (auto net : mNodes[i].inputs) {
+        readersOffsets[net + 1]++;
+      }
+    }
+    for (u32 net = 0; net < mNetCount; ++net) {
+      readersOffsets[net + 1] += readersOffsets[net];
+    }
+    std::vector<u32> readers(readersOffsets[mNetCount]);
+    {
+      std::vector<u32> cursor(readersOffsets.begin(), readersOffsets.end() - 1);
+      for (u32 i = 0; i < nodeCount; ++i) {
+        for (auto net : mNodes[i].inputs) {
+          readers[cursor[net]++] = i;
+        }
+      }
+    }
+
+    // A node is valid when all of its inputs are valid (any input for merges), this is the
+    // same rule as a component only updating when all its input pins are visited. It is solved
+    // from the other side, nets that are neither inputs nor driven invalidate everything they
+    // reach, so feedback loops stay valid as long as what drives them is.
+    std::vector<bool> valid(mNetCount, false);
+    std::vector<bool> validNodes(nodeCount, true);
+    std::vector<u32> remaining(nodeCount);
+    std::vector<NetId> stack;
+    for (auto net : netlist.mInputs) {
+      valid[net] = true;
+    }
+    for (auto& reg : netlist.mRegisters) {
+      GATE_DEBUG_ASSERT_WITH_MESSAGE(drivers[reg.q] == NO_NODE, "a net can only have one driver");
+      valid[reg.q] = true;
+    }
+    for (u32 i = 0; i < nodeCount; ++i) {
+      auto& node = mNodes[i];
+      remaining[i] = node.opcode == Opcode::Merge ? (u32)node.inputs.size() : 1;
+      for (auto net : node.outputs) {
+        valid[net] = true;
+      }
+    }
+    for (NetId net = 0; net < mNetCount; ++net) {
+      if (!valid[net]) {
+        stack.push_back(net);
+      }
+    }
+    while (!stack.empty()) {
+      NetId net = stack.back();
+      stack.pop_back();
+      for (u32 j = readersOffsets[net]; j < readersOffsets[net + 1]; ++j) {
+        u32 reader = readers[j];
+        if (!validNodes[reader] || --remaining[reader] != 0) {
+          continue;
+        }
+        validNodes[reader] = false;
+        for (auto output : mNodes[reader].outputs) {
+          if (valid[output]) {
+            valid[output] = false;
+            stack.push_back(output);
+          }
+        }
+      }
+    }
+
+    // Strongly connected components of the valid nodes (Tarjan's algorithm, without recursion).
+    // A component with more than one node, or a node that reads its own output, is a feedback loop.
+    std::vector<u32> successorsOffsets(nodeCount + 1, 0);
+    std::vector<u32> successors;
+    for (u32 i = 0; i < nodeCount; ++i) {
+      if (validNodes[i]) {
+        for (auto net : mNodes[i].outputs) {
+          for (u32 j = readersOffsets[net]; j < readersOffsets[net + 1]; ++j) {
+            if (validNodes[readers[j]]) {
+              successors.push_back(readers[j]);
+            }
+          }
+        }
+      }
+      successorsOffsets[i + 1] = (u32)successors.size();
+    }
+
+    std::vector<u32> components(nodeCount, NO_NODE);
+    std::vector<u32> order(nodeCount, NO_NODE);
+    std::vector<u32> lowLinks(nodeCount, 0);
+    std::vector<u32> componentStack;
+    std::vector<std::pair<u32, u32>> callStack;
+    std::vector<bool> loops;
+    u32 visitCount = 0;
+    for (u32 root = 0; root < nodeCount; ++root) {
+      if (!validNodes[root] || order[root] != NO_NODE) {
+        continue;
+      }
+      callStack.push_back({root, successorsOffsets[root]});
+      order[root] = lowLinks[root] = visitCount++;
+      componentStack.push_back(root);
+      while (!callStack.empty()) {
+        auto&[node, edge] = callStack.back();
+        if (edge < successorsOffsets[node + 1]) {
+          u32 successor = successors[edge++];
+          if (order[successor] == NO_NODE) {
+            order[successor] = lowLinks[successor] = visitCount++;
+            componentStack.push_back(successor);
+            callStack.push_back({successor, successorsOffsets[successor]});
+          } else if (components[successor] == NO_NODE) {
+            lowLinks[node] = std::min(lowLinks[node], order[successor]);
+          }
+          continue;
+        }
+
+        u32 finished = node;
+        callStack.pop_back();
+        if (!callStack.empty()) {
+          u32 parent = callStack.back().first;
+          lowLinks[parent] = std::min(lowLinks[parent], lowLinks[finished]);
+        }
+        if (lowLinks[finished] != order[finished]) {
+          continue;
+        }
+        u32 component = (u32)loops.size();
+        bool loop = componentStack.back() != finished;
+        u32 member;
+        do {
+          member = componentStack.back();
+          componentStack.pop_back();
+          components[member] = component;
+        } while (member != finished);
+        for (u32 j = successorsOffsets[finished]; j < successorsOffsets[finished + 1]; ++j) {
+          loop = loop || successors[j] == finished;
+        }
+        loops.push_back(loop);
+      }
+    }
+    const u32 componentCount = (u32)loops.size();
+
+    // Levelize the components, a component is one level above the highest of its drivers.
+    std::vector<u32> componentLevels(componentCount, 0);
+    std::vector<u32> indegree(componentCount, 0);
+    std::vector<u32> componentNodesOffsets(componentCount + 1, 0);
+    for (u32 i = 0; i < nodeCount; ++i) {
+      if (!validNodes[i]) {
+        continue;
+      }
+      componentNodesOffsets[components[i] + 1]++;
+      for (u32 j = successorsOffsets[i]; j < successorsOffsets[i + 1]; ++j) {
+        if (components[successors[j]] != components[i]) {
+          indegree[components[successors[j]]]++;
+        }
+      }
+    }
+    for (u32 component = 0; component < componentCount; ++component) {
+      componentNodesOffsets[component + 1] += componentNodesOffsets[component];
+    }
+    std::vector<u32> componentNodes(componentNodesOffsets[componentCount]);
+    {
+      std::vector<u32> cursor(componentNodesOffsets.begin(), componentNodesOffsets.end() - 1);
+      for (u32 i = 0; i < nodeCount; ++i) {
+        if (validNodes[i]) {
+          componentNodes[cursor[components[i]]++] = i;
+        }
+      }
+    }
+    std::vector<u32> queue;
+    for (u32 component = 0; component < componentCount; ++component) {
+      if (indegree[component] == 0) {
+        queue.push_back(component);
+      }
+    }
+    u32 levelCount = 0;
+    for (usize head = 0; head < queue.size(); ++head) {
+      u32 component = queue[head];
+      levelCount = std::max(levelCount, componentLevels[component] + 1);
+      for (u32 k = componentNodesOffsets[component]; k < componentNodesOffsets[component + 1]; ++k) {
+        u32 i = componentNodes[k];
+        for (u32 j = successorsOffsets[i]; j < successorsOffsets[i + 1]; ++j) {
+          u32 successor = components[successors[j]];
+          if (successor == component) {
+            continue;
+          }
+          componentLevels[successor] = std::max(componentLevels[successor], componentLevels[component] + 1);
+          if (--indegree[successor] == 0) {
+            queue.push_back(successor);
+          }
+        }
+      }
+    }
+    GATE_ASSERT_WITH_MESSAGE(queue.size() == componentCount, "the components of a netlist form a DAG");
+
+    // Emit the instructions sorted by level and grouped by opcode, so gates of the same
+    // type can be evaluated together. The loops of a level come last, each one contiguous.
+    static const constexpr u32 SLOT_COUNT = OPCODE_COUNT + 1;
+    auto keyOf = [&](u32 i) {
+      u32 component = components[i];
+      return componentLevels[component] * SLOT_COUNT + (loops[component] ? OPCODE_COUNT : u32(mNodes[i].opcode));
+    };
+    std::vector<u32> keyOffsets(levelCount * SLOT_COUNT + 1, 0);
+    for (u32 i = 0; i < nodeCount; ++i) {
+      if (validNodes[i]) {
+        keyOffsets[keyOf(i) + 1]++;
+      }
+    }
+    for (u32 key = 0; key + 1 < keyOffsets.size(); ++key) {
+      keyOffsets[key + 1] += keyOffsets[key];
+    }
+    netlist.mLevels.resize(levelCount + 1);
+    for (u32 level = 0; level <= levelCount; ++level) {
+      netlist.mLevels[level] = keyOffsets[level * SLOT_COUNT];
+    }
+
+    // Positions of the nodes, the nodes of a loop keep their insertion order.
+    std::vector<u32> positions(nodeCount, NO_NODE);
+    std::vector<u32> loopComponents;
+    for (u32 component = 0; component < componentCount; ++component) {
+      if (loops[component]) {
+        loopComponents.push_back(component);
+      }
+    }
+    std::stable_sort(loopComponents.begin(), loopComponents.end(), [&](u32 a, u32 b) {
+      return componentLevels[a] < componentLevels[b];
+    });
+    netlist.mLevelLoops.assign(levelCount + 1, 0);
+    for (auto component : loopComponents) {
+      u32& cursor = keyOffsets[componentLevels[component] * SLOT_COUNT + OPCODE_COUNT];
+      Loop loop{cursor, cursor};
+      for (u32 k = componentNodesOffsets[component]; k < componentNodesOffsets[component + 1]; ++k) {
+        positions[componentNodes[k]] = cursor++;
+      }
+      loop.end = cursor;
+      netlist.mLoops.push_back(loop);
+      netlist.mLevelLoops[componentLevels[component] + 1]++;
+    }
+    for (u32 level = 0; level < levelCount; ++level) {
+      netlist.mLevelLoops[level + 1] += netlist.mLevelLoops[level];
+    }
+    for (u32 i = 0; i < nodeCount; ++i) {
+      if (validNodes[i] && positions[i] == NO_NODE) {
+        positions[i] = keyOffsets[keyOf(i)]++;
+      }
+    }
+
+    netlist.mInstructions.resize(componentNodesOffsets[componentCount]);
+    netlist.mDelays.resize(netlist.mInstructions.size());
+    for (u32 i = 0; i < nodeCount; ++i) {
+      if (!validNodes[i]) {
+        continue;
+      }
+      auto& node = mNodes[i];
+      Instruction instruction{node.opcode, NULL_NET, NULL_NET, NULL_NET};
+      switch (node.opcode) {
+        case Opcode::And:
+        case Opcode::Or:
+        case Opcode::Xor:
+          instruction.a = node.inputs[0];
+          instruction.b = node.inputs[1];
+          instruction.output = node.outputs[0];
+          break;
+        case Opcode::Not:
+        case Opcode::Buffer:
+          instruction.a = node.inputs[0];
+          instruction.b = node.inputs[0];
+          instruction.output = node.outputs[0];
+          break;
+        case Opcode::Merge:
+          // Invalid drivers never change, so they can be left out.
+          instruction.a = (u32)netlist.mOperands.size();
+          for (auto net : node.inputs) {
+            if (valid[net]) {
+              netlist.mOperands.push_back(net);
+            }
+          }
+          instruction.b = (u32)netlist.mOperands.size() - instruction.a;
+          instruction.output = node.outputs[0];
+          break;
+        case Opcode::Lookup:
+        case Opcode::Read:
+          instruction.a = node.index;
+          instruction.b = node.output;
+          instruction.output = node.outputs[0];
+          break;
+      }
+      netlist.mInstructions[positions[i]] = instruction;
+      netlist.mDelays[positions[i]] = node.delay;
+    }
+
+    // Groups only cover the instructions in front of the loops of a level.
+    netlist.mLevelGroups.resize(levelCount + 1);
+    for (u32 level = 0; level < levelCount; ++level) {
+      netlist.mLevelGroups[level] = (u32)netlist.mGroups.size();
+      u32 end = netlist.mLoops.empty() || netlist.mLevelLoops[level] == netlist.mLevelLoops[level + 1]
+        ? netlist.mLevels[level + 1]
+        : netlist.mLoops[netlist.mLevelLoops[level]].begin;
+      for (u32 i = netlist.mLevels[level]; i < end; ++i) {
+        auto opcode = netlist.mInstructions[i].opcode;
+        if (i == netlist.mLevels[level] || netlist.mGroups.back().opcode != opcode) {
+          netlist.mGroups.push_back(Group{opcode, i, i + 1});
+        } else {
+          netlist.mGroups.back().end++;
+        }
+      }
+    }
+    netlist.mLevelGroups[levelCount] = (u32)netlist.mGroups.size();
+
+    // Fanout of every net, so changes can be propagated without a full evaluation.
+    auto forEachSource = [&netlist](const Instruction& instruction, auto&& function) {
+      switch (instruction.opcode) {
+        case Opcode::And:
+        case Opcode::Or:
+        case Opcode::Xor:
+          function(instruction.a);
+          if (instruction.b != instruction.a) {
+            function(instruction.b);
+          }
+          break;
+        case Opcode::Not:
+        case Opcode::Buffer:
+          function(instruction.a);
+          break;
+        case Opcode::Merge:
+          for (u32 j = 0; j < instruction.b; ++j) {
+            function(netlist.mOperands[instruction.a + j]);
+          }
+          break;
+        case Opcode::Lookup:
+          for (auto net : netlist.mLookups[instruction.a].inputs) {
+            function(net);
+          }
+          break;
+        case Opcode::Read:
+          for (auto net : netlist.mMemories[instruction.a].address) {
+            function(net);
+          }
+          break;
+      }
+    };
+    netlist.mFanoutOffsets.assign(mNetCount + 1, 0);
+    for (auto& instruction : netlist.mInstructions) {
+      forEachSource(instruction, [&](NetId net) { netlist.mFanoutOffsets[net + 1]++; });
+    }
+    for (u32 net = 0; net < mNetCount; ++net) {
+      netlist.mFanoutOffsets[net + 1] += netlist.mFanoutOffsets[net];
+    }
+    netlist.mFanout.resize(netlist.mFanoutOffsets[mNetCount]);
+    std::vector<u32> fanoutCursor(netlist.mFanoutOffsets.begin(), netlist.mFanoutOffsets.end() - 1);
+    for (u32 i = 0; i < netlist.mInstructions.size(); ++i) {
+      forEachSource(netlist.mInstructions[i], [&](NetId net) { netlist.mFanout[fanoutCursor[net]++] = i; });
+    }
+    netlist.mReadersOffsets.assign(netlist.mMemories.size() + 1, 0);
+    for (auto& instruction : netlist.mInstructions) {
+      if (instruction.opcode == Opcode::Read) {
+        netlist.mReadersOffsets[instruction.a + 1]++;
+      }
+    }
+    for (u32 memory = 0; memory < netlist.mMemories.size(); ++memory) {
+      netlist.mReadersOffsets[memory + 1] += netlist.mReadersOffsets[memory];
+    }
+    netlist.mReaders.resize(netlist.mReadersOffsets[netlist.mMemories.size()]);
+    std::vector<u32> readersCursor(netlist.mReadersOffsets.begin(), netlist.mReadersOffsets.end() - 1);
+    for (u32 i = 0; i < netlist.mInstructions.size(); ++i) {
+      if (netlist.mInstructions[i].opcode == Opcode::Read) {
+        netlist.mReaders[readersCursor[netlist.mInstructions[i].a]++] = i;
+      }
+    }
+
+    auto buildClocked = [this](auto& elements, std::vector<u32>& offsets, std::vector<u32>& clocked) {
+      offsets.assign(mNetCount + 1, 0);
+      for (auto& element : elements) {
+        if (element.clock != NULL_NET) {
+          offsets[element.clock + 1]++;
+        }
+      }
+      for (u32 net = 0; net < mNetCount; ++net) {
+        offsets[net + 1] += offsets[net];
+      }
+      clocked.resize(offsets[mNetCount]);
+      std::vector<u32> cursor(offsets.begin(), offsets.end() - 1);
+      for (u32 i = 0; i < elements.size(); ++i) {
+        if (elements[i].clock != NULL_NET) {
+          clocked[cursor[elements[i].clock]++] = i;
+        }
+      }
+    };
+    buildClocked(netlist.mRegisters, netlist.mClockedRegistersOffsets, netlist.mClockedRegisters);
+    buildClocked(netlist.mMemories, netlist.mClockedMemoriesOffsets, netlist.mClockedMemories);
+
+    netlist.mValid = std::move(valid);
+    mNodes.clear();
+    mNetCount = 0;
+    mDelay = 0;
+    return netlist;
+  }
+
+}
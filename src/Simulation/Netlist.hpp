@@ -0,0 +1,251 @@
+#pragma once
+
+#include "Core/Base.hpp"
+
+#include <vector>
+
+namespace Gate::Simulation {
+
+  using NetId = u32;
+
+  static const constexpr NetId NULL_NET = UINT32_MAX;
+
+  enum class Opcode : u8 {
+    And,
+    Or,
+    Xor,
+    Not,
+    Buffer,
+
+    // Wired-or of the operands in the range [a, a + b).
+    Merge,
+
+    // Output b of the truth table of lookup a.
+    Lookup,
+
+    // Bit b of the word of memory a at the address of its inputs.
+    Read,
+  };
+
+  struct Instruction {
+    Opcode opcode;
+    NetId a;
+    NetId b;
+    NetId output;
+  };
+
+  // Consecutive instructions of the same level with the same opcode.
+  struct Group {
+    Opcode opcode;
+    u32 begin;
+    u32 end;
+  };
+
+  // Instructions of a feedback loop (a strongly connected component of the netlist),
+  // they are evaluated repeatedly until their outputs settle.
+  struct Loop {
+    u32 begin;
+    u32 end;
+  };
+
+  // Precomputed outputs of a combinational function, for every combination of its inputs.
+  //
+  // Bit i of the words of an output is the value for the input combination i, where
+  // input j is bit j of i.
+  struct TruthTable {
+    static const constexpr u32 MAX_INPUTS = 16;
+
+    u32 inputCount;
+    u32 outputCount;
+    std::vector<u64> words;
+
+    inline usize getWordCount() const { return ((usize(1) << inputCount) + 63) / 64; }
+    inline bool get(u32 output, u32 index) const { return (words[output * getWordCount() + index / 64] >> (index % 64)) & 1; }
+  };
+
+  struct Lookup {
+    Ref<const TruthTable> table;
+    std::vector<NetId> inputs;
+  };
+
+  // A memory of 2^address.size() words of dataWidth bits, read through the Read instructions.
+  //
+  // The words are packed back to back in a byte array, word i is the bits
+  // [i * dataWidth, (i + 1) * dataWidth) least significant first. The contents are state,
+  // like the registers, the netlist only has the contents at power on (zero if there are none).
+  struct Memory {
+    static const constexpr u32 MAX_ADDRESS_WIDTH = 16;
+    static const constexpr u32 MAX_DATA_WIDTH = 64;
+
+    u32 dataWidth;
+    std::vector<NetId> address;
+
+    // The write port, data is written at the address when clock rises while write is high.
+    // A memory without a clock is read-only.
+    std::vector<NetId> data;
+    NetId write = NULL_NET;
+    NetId clock = NULL_NET;
+
+    // getByteCount() bytes, or nullptr.
+    Ref<const std::vector<u8>> contents;
+
+    inline bool isWritable() const { return clock != NULL_NET; }
+    inline usize getByteCount() const { return getByteCount((u32)address.size(), dataWidth); }
+    u64 getInitialWord(u32 index) const;
+    std::vector<u8> getInitialContents() const;
+
+    static inline usize getByteCount(u32 addressWidth, u32 dataWidth) { return ((usize(dataWidth) << addressWidth) + 7) / 8; }
+    static u64 readWord(const u8* bytes, u32 dataWidth, u32 index);
+    static void writeWord(u8* bytes, u32 dataWidth, u32 index, u64 value);
+  };
+
+  // An edge-triggered state element, q takes the value of d when clock rises.
+  //
+  // Registers are not instructions, q has no driver and is read like an input, so they
+  // never take part in the levels or the feedback loops. See Engine::propagate().
+  struct Register {
+    NetId d;
+    NetId clock;
+    NetId q;
+    u32 delay;
+  };
+
+  // A flat, levelized evaluation program of a chip.
+  //
+  // Instructions are sorted by level, so evaluating them in order always reads
+  // nets that have already been computed. Feedback loops are placed at the end of
+  // their level, they only read lower levels and themselves.
+  class Netlist {
+  public:
+    class Builder {
+    public:
+      NetId addNet();
+
+      // Consecutive nets, for the bits of a bus. Returns the first one.
+      NetId addNets(u32 count);
+      void addInput(NetId net);
+      void addOutput(NetId net);
+      void addGate(Opcode opcode, NetId a, NetId b, NetId output);
+      void addGate(Opcode opcode, NetId a, NetId output);
+
+      // Wired-or of all the drivers that are connected to the same point.
+      void addMerge(std::vector<NetId> inputs, NetId output);
+
+      // The outputs are driven by the table, indexed by the values of the inputs.
+      void addLookup(Ref<const TruthTable> table, std::vector<NetId> inputs, std::vector<NetId> outputs);
+
+      // The register is the only driver of q.
+      void addRegister(NetId d, NetId clock, NetId q);
+
+      // Output i reads bit i of the word at the address, NULL_NET outputs are not read.
+      void addMemory(Memory memory, std::vector<NetId> outputs);
+
+      // Propagation delay of the instructions added after this call, only used by TimingEngine.
+      inline void setDelay(u32 delay) { mDelay = delay; }
+
+      Netlist build();
+
+    private:
+      Builder() = default;
+
+    private:
+      struct Node {
+        Opcode opcode;
+        u32 index;
+        std::vector<NetId> inputs;
+        std::vector<NetId> outputs;
+        u32 output;
+        u32 delay;
+      };
+
+    private:
+      void push(Node node);
+
+    private:
+      u32 mNetCount = 0;
+      std::vector<NetId> mInputs;
+      std::vector<NetId> mOutputs;
+      std::vector<Node> mNodes;
+      std::vector<Lookup> mLookups;
+      std::vector<Register> mRegisters;
+      std::vector<Memory> mMemories;
+      u32 mDelay = 0;
+
+    private:
+      friend class Netlist;
+    };
+
+  public:
+    [[nodiscard]] static Builder builder();
+
+    inline u32 getNetCount() const { return mNetCount; }
+    inline const std::vector<Instruction>& getInstructions() const { return mInstructions; }
+    inline const std::vector<u32>& getLevels() const { return mLevels; }
+    inline u32 getLevelCount() const { return mLevels.empty() ? 0 : u32(mLevels.size() - 1); }
+    inline const std::vector<Group>& getGroups() const { return mGroups; }
+    inline const std::vector<u32>& getDelays() const { return mDelays; }
+
+    // Groups of level i are in the range [getLevelGroups()[i], getLevelGroups()[i + 1]).
+    inline const std::vector<u32>& getLevelGroups() const { return mLevelGroups; }
+
+    // Loops of level i are in the range [getLevelLoops()[i], getLevelLoops()[i + 1]),
+    // they come after the groups of the level.
+    inline const std::vector<Loop>& getLoops() const { return mLoops; }
+    inline const std::vector<u32>& getLevelLoops() const { return mLevelLoops; }
+    inline const std::vector<NetId>& getOperands() const { return mOperands; }
+    inline const std::vector<Lookup>& getLookups() const { return mLookups; }
+    inline const std::vector<Register>& getRegisters() const { return mRegisters; }
+    inline const std::vector<Memory>& getMemories() const { return mMemories; }
+    inline const std::vector<NetId>& getInputs() const { return mInputs; }
+    inline const std::vector<NetId>& getOutputs() const { return mOutputs; }
+
+    // Instructions that read the given net.
+    inline const u32* fanoutBegin(NetId net) const { return mFanout.data() + mFanoutOffsets[net]; }
+    inline const u32* fanoutEnd(NetId net) const { return mFanout.data() + mFanoutOffsets[net + 1]; }
+
+    // Read instructions of the given memory.
+    inline const u32* readersBegin(u32 memory) const { return mReaders.data() + mReadersOffsets[memory]; }
+    inline const u32* readersEnd(u32 memory) const { return mReaders.data() + mReadersOffsets[memory + 1]; }
+
+    // Registers and memories clocked by the given net.
+    inline const u32* clockedRegistersBegin(NetId net) const { return mClockedRegisters.data() + mClockedRegistersOffsets[net]; }
+    inline const u32* clockedRegistersEnd(NetId net) const { return mClockedRegisters.data() + mClockedRegistersOffsets[net + 1]; }
+    inline const u32* clockedMemoriesBegin(NetId net) const { return mClockedMemories.data() + mClockedMemoriesOffsets[net]; }
+    inline const u32* clockedMemoriesEnd(NetId net) const { return mClockedMemories.data() + mClockedMemoriesOffsets[net + 1]; }
+
+    // A net is valid if it is (transitively) driven by inputs and registers only, feedback
+    // loops are valid when everything that drives them is.
+    inline bool isValid(NetId net) const { return mValid[net]; }
+
+  private:
+    u32 mNetCount = 0;
+    std::vector<Instruction> mInstructions;
+    std::vector<u32> mDelays;
+
+    // Instructions of level i are in the range [mLevels[i], mLevels[i + 1]).
+    std::vector<u32> mLevels;
+    std::vector<Group> mGroups;
+    std::vector<u32> mLevelGroups;
+    std::vector<Loop> mLoops;
+    std::vector<u32> mLevelLoops;
+
+    std::vector<NetId> mOperands;
+    std::vector<Lookup> mLookups;
+    std::vector<Register> mRegisters;
+    std::vector<Memory> mMemories;
+    std::vector<NetId> mInputs;
+    std::vector<NetId> mOutputs;
+    std::vector<bool> mValid;
+
+    // Compressed rows of the instructions reading each net.
+    std::vector<u32> mFanoutOffsets;
+    std::vector<u32> mFanout;
+    std::vector<u32> mReadersOffsets;
+    std::vector<u32> mReaders;
+    std::vector<u32> mClockedRegistersOffsets;
+    std::vector<u32> mClockedRegisters;
+    std::vector<u32> mClockedMemoriesOffsets;
+    std::vector<u32> mClockedMemories;
+  };
+
+}
@@ -0,0 +1,464 @@
+#include "Simulation/Optimizer.hpp"
+
+#include <algorithm>
+#include <map>
+#include <tuple>
+
+namespace Gate::Simulation {
+
+  namespace {
+    // The value of a net as another net, possibly inverted, or as a constant.
+    using Literal = u64;
+
+    static const constexpr Literal FALSE_LITERAL = u64(NULL_NET) << 1;
+    static const constexpr Literal TRUE_LITERAL  = FALSE_LITERAL | 1;
+
+    inline Literal literalOf(NetId net) { return u64(net) << 1; }
+    inline NetId netOf(Literal literal) { return NetId(literal >> 1); }
+    inline bool isInverted(Literal literal) { return literal & 1; }
+    inline bool isConstant(Literal literal) { return netOf(literal) == NULL_NET; }
+
+    struct Node {
+      Opcode opcode;
+      u32 index;
+      std::vector<NetId> inputs;
+      std::vector<NetId> outputs;
+    };
+
+    struct Rewriter {
+      const Netlist& netlist;
+      Optimizer::Stats& stats;
+      u32 netCount;
+      std::vector<Literal> values;
+      std::vector<NetId> inverters;
+      std::vector<Node> nodes;
+      NetId falseNet = NULL_NET;
+      NetId trueNet  = NULL_NET;
+
+      // Gates that have already been emitted, by their operands.
+      std::map<std::tuple<Opcode, Literal, Literal>, Literal> gates;
+      std::map<std::vector<Literal>, Literal> merges;
+      std::map<std::pair<const TruthTable*, std::vector<Literal>>, u32> lookups;
+
+      NetId addNet() {
+        values.push_back(literalOf(netCount));
+        inverters.push_back(NULL_NET);
+        return netCount++;
+      }
+
+      // Returns a net with the value of the literal, inverters and constants are shared.
+      NetId materialize(Literal literal) {
+        if (literal == FALSE_LITERAL) {
+          if (falseNet == NULL_NET) {
+            falseNet = addNet();
+            nodes.push_back(Node{Opcode::Merge, 0, {}, {falseNet}});
+          }
+          return falseNet;
+        }
+        if (literal == TRUE_LITERAL) {
+          if (trueNet == NULL_NET) {
+            NetId input = materialize(FALSE_LITERAL);
+            trueNet = addNet();
+            nodes.push_back(Node{Opcode::Not, 0, {input}, {trueNet}});
+          }
+          return trueNet;
+        }
+        NetId net = netOf(literal);
+        if (!isInverted(literal)) {
+          return net;
+        }
+        if (inverters[net] == NULL_NET) {
+          NetId inverter = addNet();
+          inverters[net] = inverter;
+          nodes.push_back(Node{Opcode::Not, 0, {net}, {inverter}});
+        }
+        return inverters[net];
+      }
+
+      // Emits an And, Or or Xor of two literals that are neither constant nor related.
+      Literal gate(Opcode opcode, Literal a, Literal b, NetId output) {
+        bool inverted = false;
+        if (opcode == Opcode::Xor) {
+          inverted = isInverted(a) != isInverted(b);
+          a &= ~Literal(1);
+          b &= ~Literal(1);
+        } else if (isInverted(a) && isInverted(b)) {
+          // De Morgan, so both inverters can be dropped.
+          opcode = opcode == Opcode::And ? Opcode::Or : Opcode::And;
+          inverted = true;
+          a ^= 1;
+          b ^= 1;
+        }
+        if (a > b) {
+          std::swap(a, b);
+        }
+
+        auto key = std::make_tuple(opcode, a, b);
+        auto it = gates.find(key);
+        if (it != gates.end()) {
+          stats.hashed++;
+          return it->second ^ Literal(inverted);
+        }
+
+        NetId target = inverted ? addNet() : output;
+        NetId inputA = materialize(a);
+        NetId inputB = materialize(b);
+        nodes.push_back(Node{opcode, 0, {inputA, inputB}, {target}});
+        gates[key] = literalOf(target);
+        return literalOf(target) ^ Literal(inverted);
+      }
+
+      Literal binary(Opcode opcode, Literal a, Literal b, NetId output) {
+        switch (opcode) {
+          case Opcode::And:
+            if (a == FALSE_LITERAL || b == FALSE_LITERAL || a == (b ^ 1)) return FALSE_LITERAL;
+            if (a == TRUE_LITERAL) return b;
+            if (b == TRUE_LITERAL || a == b) return a;
+            break;
+          case Opcode::Or:
+            if (a == TRUE_LITERAL || b == TRUE_LITERAL || a == (b ^ 1)) return TRUE_LITERAL;
+            if (a == FALSE_LITERAL) return b;
+            if (b == FALSE_LITERAL || a == b) return a;
+            break;
+          case Opcode::Xor:
+            if (isConstant(a)) return b ^ Literal(isInverted(a));
+            if (isConstant(b)) return a ^ Literal(isInverted(b));
+            if (a == b) return FALSE_LITERAL;
+            if (a == (b ^ 1)) return TRUE_LITERAL;
+            break;
+          default:
+            GATE_UNREACHABLE("not a binary gate");
+        }
+        return gate(opcode, a, b, output);
+      }
+
+      Literal merge(std::vector<Literal> operands, NetId output) {
+        operands.erase(std::remove(operands.begin(), operands.end(), FALSE_LITERAL), operands.end());
+        std::sort(operands.begin(), operands.end());
+        operands.erase(std::unique(operands.begin(), operands.end()), operands.end());
+        for (usize i = 0; i < operands.size(); ++i) {
+          // A net and its inversion are next to each other once sorted.
+          if (operands[i] == TRUE_LITERAL || (i + 1 < operands.size() && operands[i + 1] == (operands[i] ^ 1))) {
+            return TRUE_LITERAL;
+          }
+        }
+        if (operands.empty()) {
+          return FALSE_LITERAL;
+        }
+        if (operands.size() == 1) {
+          return operands[0];
+        }
+        if (operands.size() == 2) {
+          return gate(Opcode::Or, operands[0], operands[1], output);
+        }
+
+        auto it = merges.find(operands);
+        if (it != merges.end()) {
+          stats.hashed++;
+          return it->second;
+        }
+        std::vector<NetId> inputs;
+        for (auto operand : operands) {
+          inputs.push_back(materialize(operand));
+        }
+        nodes.push_back(Node{Opcode::Merge, 0, std::move(inputs), {output}});
+        merges[std::move(operands)] = literalOf(output);
+        return literalOf(output);
+      }
+
+      void lookup(u32 index, const std::vector<NetId>& outputs) {
+        auto& lookup = netlist.getLookups()[index];
+        std::vector<Literal> operands;
+        for (auto net : lookup.inputs) {
+          operands.push_back(values[net]);
+        }
+
+        auto key = std::make_pair(lookup.table.get(), operands);
+        auto it = lookups.find(key);
+        if (it != lookups.end()) {
+          stats.hashed += (u32)outputs.size();
+          for (u32 i = 0; i < outputs.size(); ++i) {
+            values[outputs[i]] = literalOf(nodes[it->second].outputs[i]);
+          }
+          return;
+        }
+        std::vector<NetId> inputs;
+        for (auto operand : operands) {
+          inputs.push_back(materialize(operand));
+        }
+        lookups[std::move(key)] = (u32)nodes.size();
+        nodes.push_back(Node{Opcode::Lookup, index, std::move(inputs), outputs});
+      }
+
+      // Instructions of loops are kept, with their operands rewritten.
+      void keep(const Instruction& instruction) {
+        switch (instruction.opcode) {
+          case Opcode::And:
+          case Opcode::Or:
+          case Opcode::Xor:
+            nodes.push_back(Node{instruction.opcode, 0, {materialize(values[instruction.a]), materialize(values[instruction.b])}, {instruction.output}});
+            break;
+          case Opcode::Not:
+          case Opcode::Buffer:
+            nodes.push_back(Node{instruction.opcode, 0, {materialize(values[instruction.a])}, {instruction.output}});
+            break;
+          case Opcode::Merge: {
+            std::vector<NetId> inputs;
+            for (u32 i = 0; i < instruction.b; ++i) {
+              inputs.push_back(materialize(values[netlist.getOperands()[instruction.a + i]]));
+            }
+            nodes.push_back(Node{Opcode::Merge, 0, std::move(inputs), {instruction.output}});
+          } break;
+          case Opcode::Lookup: {
+            auto& lookup = netlist.getLookups()[instruction.a];
+            std::vector<NetId> inputs;
+            for (auto net : lookup.inputs) {
+              inputs.push_back(materialize(values[net]));
+            }
+            std::vector<NetId> outputs(lookup.table->outputCount, NULL_NET);
+            outputs[instruction.b] = instruction.output;
+            nodes.push_back(Node{Opcode::Lookup, instruction.a, std::move(inputs), std::move(outputs)});
+          } break;
+          case Opcode::Read:
+            GATE_UNREACHABLE("reads are rewritten with their memory");
+        }
+      }
+    };
+  }
+
+  Netlist Optimizer::optimize(const Netlist& netlist, const std::vector<NetId>& observed, Stats* stats) {
+    Stats localStats;
+    Stats& result = stats ? *stats : localStats;
+    result = Stats{};
+
+    auto& instructions = netlist.getInstructions();
+    Rewriter rewriter{netlist, result, 0, {}, {}, {}, NULL_NET, NULL_NET, {}, {}, {}};
+    for (u32 net = 0; net < netlist.getNetCount(); ++net) {
+      rewriter.addNet();
+    }
+
+    std::vector<bool> inLoop(instructions.size(), false);
+    for (auto& loop : netlist.getLoops()) {
+      std::fill(inLoop.begin() + loop.begin, inLoop.begin() + loop.end, true);
+    }
+
+    // The outputs of a lookup are separate instructions, they are rewritten together.
+    std::vector<std::vector<NetId>> lookupOutputs(netlist.getLookups().size());
+    for (u32 i = 0; i < netlist.getLookups().size(); ++i) {
+      lookupOutputs[i].assign(netlist.getLookups()[i].table->outputCount, NULL_NET);
+    }
+    for (u32 i = 0; i < instructions.size(); ++i) {
+      if (instructions[i].opcode == Opcode::Lookup && !inLoop[i]) {
+        lookupOutputs[instructions[i].a][instructions[i].b] = instructions[i].output;
+      }
+    }
+
+    // Operands always come before their readers, except inside of loops.
+    auto& values = rewriter.values;
+    for (u32 i = 0; i < instructions.size(); ++i) {
+      auto& instruction = instructions[i];
+      if (instruction.opcode == Opcode::Read) {
+        continue;
+      }
+      if (inLoop[i]) {
+        rewriter.keep(instruction);
+        continue;
+      }
+
+      const u32 nodeCount = (u32)rewriter.nodes.size();
+      const u32 hashed = result.hashed;
+      Literal value = literalOf(instruction.output);
+      switch (instruction.opcode) {
+        case Opcode::And:
+        case Opcode::Or:
+        case Opcode::Xor:
+          value = rewriter.binary(instruction.opcode, values[instruction.a], values[instruction.b], instruction.output);
+          break;
+        case Opcode::Not:
+          value = values[instruction.a] ^ 1;
+          break;
+        case Opcode::Buffer:
+          value = values[instruction.a];
+          break;
+        case Opcode::Merge: {
+          std::vector<Literal> operands;
+          for (u32 j = 0; j < instruction.b; ++j) {
+            operands.push_back(values[netlist.getOperands()[instruction.a + j]]);
+          }
+          value = rewriter.merge(std::move(operands), instruction.output);
+        } break;
+        case Opcode::Lookup: {
+          auto& outputs = lookupOutputs[instruction.a];
+          if (outputs.empty()) {
+            continue;
+          }
+          rewriter.lookup(instruction.a, outputs);
+          outputs.clear();
+          continue;
+        }
+        case Opcode::Read:
+          break;
+      }
+      values[instruction.output] = value;
+
+      // Nothing was emitted and nothing was found, the instruction was folded away.
+      if (rewriter.nodes.size() == nodeCount && result.hashed == hashed) {
+        result.folded++;
+      }
+    }
+
+    // Observed nets and outputs must hold their own value, aliases are copied back to them.
+    std::vector<NetId> roots(observed.begin(), observed.end());
+    roots.insert(roots.end(), netlist.getOutputs().begin(), netlist.getOutputs().end());
+    std::sort(roots.begin(), roots.end());
+    roots.erase(std::unique(roots.begin(), roots.end()), roots.end());
+    for (auto net : roots) {
+      if (net >= netlist.getNetCount()) {
+        continue;
+      }
+      Literal value = values[net];
+      if (value == literalOf(net)) {
+        continue;
+      }
+      if (value == FALSE_LITERAL) {
+        rewriter.nodes.push_back(Node{Opcode::Merge, 0, {}, {net}});
+      } else {
+        NetId source = isConstant(value) ? rewriter.materialize(FALSE_LITERAL) : netOf(value);
+        rewriter.nodes.push_back(Node{isInverted(value) ? Opcode::Not : Opcode::Buffer, 0, {source}, {net}});
+      }
+    }
+
+    // Registers and memories are always kept, their inputs are rewritten like the ones of loops.
+    // The reads of a memory become a single node.
+    std::vector<Register> registers = netlist.getRegisters();
+    for (auto& reg : registers) {
+      reg.d     = rewriter.materialize(values[reg.d]);
+      reg.clock = rewriter.materialize(values[reg.clock]);
+    }
+    std::vector<Memory> memories = netlist.getMemories();
+    std::vector<std::vector<NetId>> memoryOutputs(memories.size());
+    for (u32 i = 0; i < memories.size(); ++i) {
+      memoryOutputs[i].assign(memories[i].dataWidth, NULL_NET);
+    }
+    for (auto& instruction : instructions) {
+      if (instruction.opcode == Opcode::Read) {
+        memoryOutputs[instruction.a][instruction.b] = instruction.output;
+      }
+    }
+    for (u32 i = 0; i < memories.size(); ++i) {
+      auto& memory = memories[i];
+      for (auto& net : memory.address) {
+        net = rewriter.materialize(values[net]);
+      }
+      for (auto& net : memory.data) {
+        net = rewriter.materialize(values[net]);
+      }
+      if (memory.isWritable()) {
+        memory.write = rewriter.materialize(values[memory.write]);
+        memory.clock = rewriter.materialize(values[memory.clock]);
+      }
+      rewriter.nodes.push_back(Node{Opcode::Read, i, memory.address, std::move(memoryOutputs[i])});
+    }
+
+    // Sweep the nodes that none of the roots depend on, memories are always kept.
+    auto& nodes = rewriter.nodes;
+    std::vector<u32> drivers(rewriter.netCount, UINT32_MAX);
+    for (u32 i = 0; i < nodes.size(); ++i) {
+      for (auto net : nodes[i].outputs) {
+        if (net != NULL_NET) {
+          drivers[net] = i;
+        }
+      }
+    }
+    std::vector<bool> live(nodes.size(), false);
+    std::vector<u32> stack;
+    auto mark = [&](NetId net) {
+      if (net < drivers.size() && drivers[net] != UINT32_MAX && !live[drivers[net]]) {
+        live[drivers[net]] = true;
+        stack.push_back(drivers[net]);
+      }
+    };
+    for (auto net : roots) {
+      mark(net);
+    }
+    for (auto& reg : registers) {
+      mark(reg.d);
+      mark(reg.clock);
+    }
+    for (auto& memory : memories) {
+      for (auto net : memory.data) {
+        mark(net);
+      }
+      if (memory.isWritable()) {
+        mark(memory.write);
+        mark(memory.clock);
+      }
+    }
+    for (u32 i = 0; i < nodes.size(); ++i) {
+      if (nodes[i].opcode == Opcode::Read && !live[i]) {
+        live[i] = true;
+        stack.push_back(i);
+      }
+    }
+    while (!stack.empty()) {
+      u32 node = stack.back();
+      stack.pop_back();
+      for (auto net : nodes[node].inputs) {
+        mark(net);
+      }
+    }
+
+    auto builder = Netlist::builder();
+    for (u32 net = 0; net < rewriter.netCount; ++net) {
+      builder.addNet();
+    }
+    for (auto net : netlist.getInputs()) {
+      builder.addInput(net);
+    }
+    for (auto net : netlist.getOutputs()) {
+      builder.addOutput(net);
+    }
+    for (auto& reg : registers) {
+      builder.addRegister(reg.d, reg.clock, reg.q);
+    }
+    for (u32 i = 0; i < nodes.size(); ++i) {
+      auto& node = nodes[i];
+      if (!live[i]) {
+        result.swept++;
+        continue;
+      }
+      switch (node.opcode) {
+        case Opcode::And:
+        case Opcode::Or:
+        case Opcode::Xor:
+          builder.addGate(node.opcode, node.inputs[0], node.inputs[1], node.outputs[0]);
+          break;
+        case Opcode::Not:
+        case Opcode::Buffer:
+          builder.addGate(node.opcode, node.inputs[0], node.outputs[0]);
+          break;
+        case Opcode::Merge:
+          builder.addMerge(std::move(node.inputs), node.outputs[0]);
+          break;
+        case Opcode::Lookup: {
+          // Outputs that aren't read get a net of their own.
+          for (auto& net : node.outputs) {
+            if (net == NULL_NET) {
+              net = builder.addNet();
+            }
+          }
+          builder.addLookup(netlist.getLookups()[node.index].table, std::move(node.inputs), std::move(node.outputs));
+        } break;
+        case Opcode::Read:
+          builder.addMemory(std::move(memories[node.index]), std::move(node.outputs));
+          break;
+      }
+    }
+
+    Netlist optimized = builder.build();
+    result.instructions = (u32)instructions.size();
+    result.optimizedInstructions = (u32)optimized.getInstructions().size();
+    return optimized;
+  }
+
+}
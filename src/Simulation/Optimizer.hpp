@@ -0,0 +1,33 @@
+#pragma once
+
+#include "Core/Base.hpp"
+#include "Simulation/Netlist.hpp"
+
+#include <vector>
+
+namespace Gate::Simulation {
+
+  // Shrinks a netlist without changing the values of the nets that are observed.
+  //
+  // Constants and identities are folded (e.g. a & ~a, a ^ a, double inverters and buffers),
+  // identical gates are merged (structural hashing) and logic that reaches neither an output
+  // nor an observed net is removed. The net ids are preserved, removed nets are left undriven,
+  // and new nets are appended for the inverters and constants that are needed.
+  //
+  // Feedback loops and the inputs of lookups are kept as they are, only their operands
+  // are rewritten.
+  class Optimizer {
+  public:
+    struct Stats {
+      u32 instructions = 0;
+      u32 folded = 0;
+      u32 hashed = 0;
+      u32 swept = 0;
+      u32 optimizedInstructions = 0;
+    };
+
+  public:
+    static Netlist optimize(const Netlist& netlist, const std::vector<NetId>& observed, Stats* stats = nullptr);
+  };
+
+}
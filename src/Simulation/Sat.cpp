@@ -0,0 +1,451 @@
+#include "Simulation/Sat.hpp"
+
+#include <algorithm>
+
+namespace Gate::Simulation {
+
+  namespace {
+    static const constexpr u32 NOT_IN_HEAP = UINT32_MAX;
+    static const constexpr SatSolver::Literal NO_LITERAL = UINT32_MAX;
+
+    static const constexpr f64 ACTIVITY_DECAY = 0.95;
+    static const constexpr f64 ACTIVITY_LIMIT = 1e100;
+
+    // Learnt clauses with at most this literal block distance are never dropped.
+    static const constexpr u32 GLUE_LBD = 2;
+
+    // 1, 1, 2, 1, 1, 2, 4, 1, 1, 2, 1, 1, 2, 4, 8, ...
+    u64 luby(u32 index) {
+      u64 size = 1;
+      u32 sequence = 0;
+      while (size < u64(index) + 1) {
+        sequence++;
+        size = 2 * size + 1;
+      }
+      u64 x = index;
+      while (size - 1 != x) {
+        size = (size - 1) >> 1;
+        sequence--;
+        x = x % size;
+      }
+      return u64(1) << sequence;
+    }
+  }
+
+  u32 SatSolver::addVariable() {
+    const u32 variable = (u32)mAssigns.size();
+    mAssigns.push_back(UNASSIGNED);
+    mPhases.push_back(0);
+    mLevels.push_back(0);
+    mReasons.push_back(NO_CLAUSE);
+    mActivity.push_back(0.0);
+    mHeapIndexes.push_back(NOT_IN_HEAP);
+    mSeen.push_back(0);
+    mLevelStamps.resize(mAssigns.size() + 1, 0);
+    mWatches.resize(mAssigns.size() * 2);
+    heapInsert(variable);
+    return variable;
+  }
+
+  bool SatSolver::addClause(std::vector<Literal> literals) {
+    GATE_ASSERT(getDecisionLevel() == 0);
+    if (mUnsatisfiable) {
+      return false;
+    }
+
+    // A literal and its negation are next to each other once sorted.
+    std::sort(literals.begin(), literals.end());
+    usize size = 0;
+    for (usize i = 0; i < literals.size(); ++i) {
+      const Literal literal = literals[i];
+      GATE_ASSERT(variableOf(literal) < mAssigns.size());
+      if (valueOf(literal) == 1 || (i + 1 < literals.size() && literals[i + 1] == (literal ^ 1))) {
+        return true;
+      }
+      if (valueOf(literal) == 0 || (size > 0 && literals[size - 1] == literal)) {
+        continue;
+      }
+      literals[size++] = literal;
+    }
+    literals.resize(size);
+
+    mOriginalCount++;
+    if (literals.empty()) {
+      mUnsatisfiable = true;
+      return false;
+    }
+    if (literals.size() == 1) {
+      assign(literals[0], NO_CLAUSE);
+      if (propagate() != NO_CLAUSE) {
+        mUnsatisfiable = true;
+        return false;
+      }
+      return true;
+    }
+    attach(literals, false, 0);
+    return true;
+  }
+
+  SatSolver::Result SatSolver::solve(u64 conflictLimit) {
+    if (mUnsatisfiable) {
+      return Result::Unsatisfiable;
+    }
+    if (propagate() != NO_CLAUSE) {
+      mUnsatisfiable = true;
+      return Result::Unsatisfiable;
+    }
+    mMaxLearnts = std::max<u32>(10000, (u32)mClauses.size() / 3);
+
+    const u64 firstConflict = mConflictCount;
+    std::vector<Literal> learnt;
+    for (u32 restart = 0;; ++restart) {
+      const u64 budget = RESTART_BASE * luby(restart);
+      u64 conflicts = 0;
+      while (true) {
+        const u32 conflict = propagate();
+        if (conflict != NO_CLAUSE) {
+          mConflictCount++;
+          conflicts++;
+          if (getDecisionLevel() == 0) {
+            mUnsatisfiable = true;
+            return Result::Unsatisfiable;
+          }
+
+          u32 backtrackLevel = 0;
+          u32 lbd = 0;
+          analyze(conflict, learnt, backtrackLevel, lbd);
+          backtrack(backtrackLevel);
+          assign(learnt[0], learnt.size() == 1 ? NO_CLAUSE : attach(learnt, true, lbd));
+          mIncrement /= ACTIVITY_DECAY;
+
+          if (conflictLimit != 0 && mConflictCount - firstConflict >= conflictLimit) {
+            backtrack(0);
+            return Result::Unknown;
+          }
+          continue;
+        }
+        if (conflicts >= budget) {
+          break;
+        }
+
+        const u32 variable = pickBranchVariable();
+        if (variable == UINT32_MAX) {
+          mModel = mAssigns;
+          backtrack(0);
+          return Result::Satisfiable;
+        }
+        mLevelStarts.push_back((u32)mTrail.size());
+        assign(literal(variable, !mPhases[variable]), NO_CLAUSE);
+      }
+
+      backtrack(0);
+      if (mLearntCount >= mMaxLearnts) {
+        if (!simplify()) {
+          mUnsatisfiable = true;
+          return Result::Unsatisfiable;
+        }
+        mMaxLearnts += mMaxLearnts / 10;
+      }
+    }
+  }
+
+  u32 SatSolver::attach(const std::vector<Literal>& literals, bool learnt, u32 lbd) {
+    GATE_ASSERT(literals.size() >= 2);
+    const u32 index = (u32)mClauses.size();
+    mClauses.push_back(Clause{(u32)mLiterals.size(), (u32)literals.size(), lbd, learnt});
+    mLiterals.insert(mLiterals.end(), literals.begin(), literals.end());
+    mWatches[literals[0] ^ 1].push_back(Watch{index, literals[1]});
+    mWatches[literals[1] ^ 1].push_back(Watch{index, literals[0]});
+    mLearntCount += learnt;
+    return index;
+  }
+
+  void SatSolver::assign(Literal literal, u32 reason) {
+    const u32 variable = variableOf(literal);
+    mAssigns[variable] = u8(!isNegated(literal));
+    mLevels[variable] = getDecisionLevel();
+    mReasons[variable] = reason;
+    mTrail.push_back(literal);
+  }
+
+  u32 SatSolver::propagate() {
+    while (mPropagated < mTrail.size()) {
+      const Literal literal = mTrail[mPropagated++];
+      const Literal falseLiteral = literal ^ 1;
+      auto& watches = mWatches[literal];
+
+      usize i = 0;
+      usize j = 0;
+      while (i < watches.size()) {
+        const Watch watch = watches[i++];
+        if (valueOf(watch.blocker) == 1) {
+          watches[j++] = watch;
+          continue;
+        }
+
+        // The false literal goes second, the first one is implied if nothing else can be watched.
+        auto& clause = mClauses[watch.clause];
+        Literal* literals = mLiterals.data() + clause.begin;
+        if (literals[0] == falseLiteral) {
+          std::swap(literals[0], literals[1]);
+        }
+        const Watch updated{watch.clause, literals[0]};
+        if (literals[0] != watch.blocker && valueOf(literals[0]) == 1) {
+          watches[j++] = updated;
+          continue;
+        }
+
+        bool moved = false;
+        for (u32 k = 2; k < clause.size; ++k) {
+          if (valueOf(literals[k]) != 0) {
+            std::swap(literals[1], literals[k]);
+            mWatches[literals[1] ^ 1].push_back(updated);
+            moved = true;
+            break;
+          }
+        }
+        if (moved) {
+          continue;
+        }
+
+        watches[j++] = updated;
+        if (valueOf(literals[0]) == 0) {
+          while (i < watches.size()) {
+            watches[j++] = watches[i++];
+          }
+          watches.resize(j);
+          mPropagated = (u32)mTrail.size();
+          return watch.clause;
+        }
+        assign(literals[0], watch.clause);
+      }
+      watches.resize(j);
+    }
+    return NO_CLAUSE;
+  }
+
+  void SatSolver::analyze(u32 conflict, std::vector<Literal>& learnt, u32& backtrackLevel, u32& lbd) {
+    learnt.clear();
+    learnt.push_back(NO_LITERAL);
+
+    // Walks the trail back from the conflict, until a single literal of the current level is left.
+    const u32 level = getDecisionLevel();
+    u32 pathCount = 0;
+    Literal implied = NO_LITERAL;
+    usize index = mTrail.size();
+    u32 clause = conflict;
+    do {
+      auto& reason = mClauses[clause];
+      const Literal* literals = mLiterals.data() + reason.begin;
+      for (u32 j = implied == NO_LITERAL ? 0 : 1; j < reason.size; ++j) {
+        const u32 variable = variableOf(literals[j]);
+        if (mSeen[variable] || mLevels[variable] == 0) {
+          continue;
+        }
+        mSeen[variable] = 1;
+        bump(variable);
+        if (mLevels[variable] >= level) {
+          pathCount++;
+        } else {
+          learnt.push_back(literals[j]);
+        }
+      }
+      while (!mSeen[variableOf(mTrail[--index])]) {}
+      implied = mTrail[index];
+      clause = mReasons[variableOf(implied)];
+      mSeen[variableOf(implied)] = 0;
+      pathCount--;
+    } while (pathCount > 0);
+    learnt[0] = implied ^ 1;
+
+    // A literal is redundant if the rest of its reason is already in the clause.
+    const std::vector<Literal> analyzed(learnt.begin() + 1, learnt.end());
+    usize size = 1;
+    for (usize i = 1; i < learnt.size(); ++i) {
+      const u32 reason = mReasons[variableOf(learnt[i])];
+      bool redundant = reason != NO_CLAUSE;
+      for (u32 k = 1; redundant && k < mClauses[reason].size; ++k) {
+        const u32 variable = variableOf(mLiterals[mClauses[reason].begin + k]);
+        redundant = mSeen[variable] || mLevels[variable] == 0;
+      }
+      if (!redundant) {
+        learnt[size++] = learnt[i];
+      }
+    }
+    learnt.resize(size);
+    for (auto literal : analyzed) {
+      mSeen[variableOf(literal)] = 0;
+    }
+
+    // The literal of the highest level goes second, it is watched with the asserting one.
+    backtrackLevel = 0;
+    for (usize i = 1; i < learnt.size(); ++i) {
+      if (mLevels[variableOf(learnt[i])] > backtrackLevel) {
+        backtrackLevel = mLevels[variableOf(learnt[i])];
+        std::swap(learnt[1], learnt[i]);
+      }
+    }
+
+    mStamp++;
+    lbd = 0;
+    for (auto literal : learnt) {
+      const u32 literalLevel = mLevels[variableOf(literal)];
+      if (mLevelStamps[literalLevel] != mStamp) {
+        mLevelStamps[literalLevel] = mStamp;
+        lbd++;
+      }
+    }
+  }
+
+  void SatSolver::backtrack(u32 level) {
+    if (getDecisionLevel() <= level) {
+      return;
+    }
+    for (usize i = mTrail.size(); i-- > mLevelStarts[level];) {
+      const u32 variable = variableOf(mTrail[i]);
+      mPhases[variable] = mAssigns[variable];
+      mAssigns[variable] = UNASSIGNED;
+      mReasons[variable] = NO_CLAUSE;
+      heapInsert(variable);
+    }
+    mTrail.resize(mLevelStarts[level]);
+    mLevelStarts.resize(level);
+    mPropagated = (u32)mTrail.size();
+  }
+
+  u32 SatSolver::pickBranchVariable() {
+    while (!mHeap.empty()) {
+      const u32 variable = heapPop();
+      if (mAssigns[variable] == UNASSIGNED) {
+        return variable;
+      }
+    }
+    return UINT32_MAX;
+  }
+
+  void SatSolver::bump(u32 variable) {
+    mActivity[variable] += mIncrement;
+    if (mActivity[variable] > ACTIVITY_LIMIT) {
+      for (auto& activity : mActivity) {
+        activity /= ACTIVITY_LIMIT;
+      }
+      mIncrement /= ACTIVITY_LIMIT;
+    }
+    if (mHeapIndexes[variable] != NOT_IN_HEAP) {
+      heapUp(mHeapIndexes[variable]);
+    }
+  }
+
+  bool SatSolver::simplify() {
+    GATE_ASSERT(getDecisionLevel() == 0);
+    if (propagate() != NO_CLAUSE) {
+      return false;
+    }
+    // Nothing is analyzed at level 0, so its reasons aren't needed anymore.
+    for (auto literal : mTrail) {
+      mReasons[variableOf(literal)] = NO_CLAUSE;
+    }
+
+    // The better half of the learnt clauses is kept, the newest first for the same distance.
+    std::vector<u32> learnts;
+    for (u32 i = 0; i < mClauses.size(); ++i) {
+      if (mClauses[i].learnt) {
+        learnts.push_back(i);
+      }
+    }
+    std::sort(learnts.begin(), learnts.end(), [&](u32 a, u32 b) {
+      return mClauses[a].lbd != mClauses[b].lbd ? mClauses[a].lbd < mClauses[b].lbd : a > b;
+    });
+    std::vector<u8> dropped(mClauses.size(), 0);
+    for (usize i = learnts.size() / 2; i < learnts.size(); ++i) {
+      dropped[learnts[i]] = mClauses[learnts[i]].lbd > GLUE_LBD;
+    }
+
+    // Satisfied clauses are dropped and false literals removed, the watches are rebuilt.
+    auto clauses = std::move(mClauses);
+    auto literals = std::move(mLiterals);
+    mClauses.clear();
+    mLiterals.clear();
+    mLearntCount = 0;
+    for (auto& watches : mWatches) {
+      watches.clear();
+    }
+    std::vector<Literal> kept;
+    for (u32 i = 0; i < clauses.size(); ++i) {
+      if (dropped[i]) {
+        continue;
+      }
+      kept.clear();
+      bool satisfied = false;
+      for (u32 k = 0; k < clauses[i].size && !satisfied; ++k) {
+        const Literal literal = literals[clauses[i].begin + k];
+        satisfied = valueOf(literal) == 1;
+        if (valueOf(literal) == UNASSIGNED) {
+          kept.push_back(literal);
+        }
+      }
+      if (!satisfied) {
+        attach(kept, clauses[i].learnt, clauses[i].lbd);
+      }
+    }
+    return true;
+  }
+
+  void SatSolver::heapInsert(u32 variable) {
+    if (mHeapIndexes[variable] != NOT_IN_HEAP) {
+      return;
+    }
+    mHeapIndexes[variable] = (u32)mHeap.size();
+    mHeap.push_back(variable);
+    heapUp(mHeapIndexes[variable]);
+  }
+
+  u32 SatSolver::heapPop() {
+    const u32 variable = mHeap[0];
+    mHeap[0] = mHeap.back();
+    mHeapIndexes[mHeap[0]] = 0;
+    mHeap.pop_back();
+    mHeapIndexes[variable] = NOT_IN_HEAP;
+    if (!mHeap.empty()) {
+      heapDown(0);
+    }
+    return variable;
+  }
+
+  void SatSolver::heapUp(u32 index) {
+    const u32 variable = mHeap[index];
+    while (index > 0) {
+      const u32 parent = (index - 1) / 2;
+      if (!isHigher(variable, mHeap[parent])) {
+        break;
+      }
+      mHeap[index] = mHeap[parent];
+      mHeapIndexes[mHeap[index]] = index;
+      index = parent;
+    }
+    mHeap[index] = variable;
+    mHeapIndexes[variable] = index;
+  }
+
+  void SatSolver::heapDown(u32 index) {
+    const u32 variable = mHeap[index];
+    while (true) {
+      u32 child = index * 2 + 1;
+      if (child >= mHeap.size()) {
+        break;
+      }
+      if (child + 1 < mHeap.size() && isHigher(mHeap[child + 1], mHeap[child])) {
+        child++;
+      }
+      if (!isHigher(mHeap[child], variable)) {
+        break;
+      }
+      mHeap[index] = mHeap[child];
+      mHeapIndexes[mHeap[index]] = index;
+      index = child;
+    }
+    mHeap[index] = variable;
+    mHeapIndexes[variable] = index;
+  }
+
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "Core/Base.hpp"
+
+#include <vector>
+
+namespace Gate::Simulation {
+
+  // A small conflict driven clause learning SAT solver, for the proofs of EquivalenceChecker.
+  //
+  // Clauses are watched by two of their literals, conflicts are analyzed up to the first unique
+  // implication point, the branching variable is the most active one (VSIDS) with its last value
+  // (phase saving). The search restarts on a Luby sequence, and the learnt clauses with the
+  // worst literal block distance are dropped on restarts.
+  class SatSolver {
+  public:
+    // Variable v as 2v, its negation as 2v + 1.
+    using Literal = u32;
+
+    enum class Result : u8 {
+      Satisfiable,
+      Unsatisfiable,
+
+      // The conflict limit was reached.
+      Unknown,
+    };
+
+    // Conflicts between restarts are this times the Luby sequence.
+    static const constexpr u32 RESTART_BASE = 100;
+
+    static inline Literal literal(u32 variable, bool negated = false) { return variable * 2 + negated; }
+    static inline u32 variableOf(Literal literal) { return literal >> 1; }
+    static inline bool isNegated(Literal literal) { return literal & 1; }
+
+  public:
+    u32 addVariable();
+
+    // Returns false if the clauses are already unsatisfiable.
+    bool addClause(std::vector<Literal> literals);
+
+    // A limit of 0 is no limit.
+    Result solve(u64 conflictLimit = 0);
+
+    // The model of the last satisfiable solve().
+    inline bool getValue(u32 variable) const { return mModel[variable] != 0; }
+
+    inline u32 getVariableCount() const { return (u32)mAssigns.size(); }
+    inline u32 getClauseCount() const { return mOriginalCount; }
+    inline u64 getConflictCount() const { return mConflictCount; }
+
+  private:
+    static const constexpr u32 NO_CLAUSE = UINT32_MAX;
+    static const constexpr u8 UNASSIGNED = 2;
+
+    struct Clause {
+      u32 begin;
+      u32 size;
+      u32 lbd;
+      bool learnt;
+    };
+
+    struct Watch {
+      u32 clause;
+
+      // A literal of the clause, if it is true the clause doesn't have to be visited.
+      Literal blocker;
+    };
+
+  private:
+    // 1 if true, 0 if false, UNASSIGNED otherwise.
+    inline u8 valueOf(Literal literal) const { u8 value = mAssigns[variableOf(literal)]; return value == UNASSIGNED ? value : value ^ u8(isNegated(literal)); }
+    inline u32 getDecisionLevel() const { return (u32)mLevelStarts.size(); }
+
+    u32 attach(const std::vector<Literal>& literals, bool learnt, u32 lbd);
+    void assign(Literal literal, u32 reason);
+    u32 propagate();
+    void analyze(u32 conflict, std::vector<Literal>& learnt, u32& backtrackLevel, u32& lbd);
+    void backtrack(u32 level);
+    u32 pickBranchVariable();
+    void bump(u32 variable);
+    bool simplify();
+
+    // Binary heap of the unassigned variables, by activity.
+    bool isHigher(u32 a, u32 b) const { return mActivity[a] > mActivity[b]; }
+    void heapInsert(u32 variable);
+    u32 heapPop();
+    void heapUp(u32 index);
+    void heapDown(u32 index);
+
+  private:
+    bool mUnsatisfiable = false;
+    u32 mOriginalCount = 0;
+    u64 mConflictCount = 0;
+
+    std::vector<Literal> mLiterals;
+    std::vector<Clause> mClauses;
+    u32 mLearntCount = 0;
+    u32 mMaxLearnts = 0;
+
+    // Watches of the clauses that become false with a literal, by the negation of that literal.
+    std::vector<std::vector<Watch>> mWatches;
+
+    // Assignment
+    std::vector<u8> mAssigns;
+    std::vector<u8> mPhases;
+    std::vector<u32> mLevels;
+    std::vector<u32> mReasons;
+    std::vector<Literal> mTrail;
+    std::vector<u32> mLevelStarts;
+    u32 mPropagated = 0;
+    std::vector<u8> mModel;
+
+    // Branching heuristic
+    std::vector<f64> mActivity;
+    f64 mIncrement = 1.0;
+    std::vector<u32> mHeap;
+    std::vector<u32> mHeapIndexes;
+
+    // Conflict analysis
+    std::vector<u8> mSeen;
+    std::vector<u32> mLevelStamps;
+    u32 mStamp = 0;
+  };
+
+}
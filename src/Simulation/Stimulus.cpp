@@ -0,0 +1,116 @@
+#include "Simulation/Stimulus.hpp"
+#include "Simulation/Engine.hpp"
+#include "Simulation/Vectors.hpp"
+#include "Core/ThreadPool.hpp"
+
+#include <algorithm>
+
+namespace Gate::Simulation {
+
+  namespace {
+    u64 grayWord(u64 batch, u32 input) {
+      return input < 64 ? indexBits(batch, input) ^ indexBits(batch, input + 1) : 0;
+    }
+  }
+
+  StimulusGenerator::Report StimulusGenerator::run(const Netlist& netlist, const Options& options) {
+    const u32 netCount = netlist.getNetCount();
+    const usize inputCount = netlist.getInputs().size();
+
+    Report report;
+    std::vector<u8> driven(netCount, 0);
+    for (auto net : netlist.getInputs()) {
+      driven[net] = 1;
+    }
+    for (auto& instruction : netlist.getInstructions()) {
+      driven[instruction.output] = 1;
+    }
+    report.netCount = (u32)std::count(driven.begin(), driven.end(), u8(1));
+    report.toggled.assign(netCount, 0);
+
+    // Every chunk of a round has its own engine, and records which values its nets took.
+    auto& pool = ThreadPool::get();
+    const u32 chunkCount = pool.getThreadCount();
+    const u32 chunkBatches = std::min<u32>(BATCHES_PER_THREAD, Engine::MAX_STRIDE);
+    std::vector<Engine> engines(chunkCount);
+    std::vector<std::vector<u64>> inputs(chunkCount);
+    std::vector<std::vector<u8>> seenLow(chunkCount, std::vector<u8>(netCount, 0));
+    std::vector<std::vector<u8>> seenHigh(chunkCount, std::vector<u8>(netCount, 0));
+    for (auto& engine : engines) {
+      engine.load(netlist);
+      engine.setParallel(false);
+    }
+
+    const u64 combinations = inputCount < 64 ? u64(1) << inputCount : UINT64_MAX;
+    u64 batch = 0;
+    u32 staleRounds = 0;
+    while (report.vectorCount < options.maxVectors) {
+      const u64 remainingBatches = (options.maxVectors - report.vectorCount + 63) / 64;
+      const u32 roundBatches = (u32)std::min<u64>(u64(chunkCount) * chunkBatches, remainingBatches);
+      const u32 roundChunks = (roundBatches + chunkBatches - 1) / chunkBatches;
+
+      pool.parallelFor(roundChunks, 1, [&](u32 begin, u32 end) {
+        for (u32 chunk = begin; chunk < end; ++chunk) {
+          const u32 batches = std::min(chunkBatches, roundBatches - chunk * chunkBatches);
+          const u64 firstBatch = batch + u64(chunk) * chunkBatches;
+
+          auto& words = inputs[chunk];
+          words.resize(usize(batches) * inputCount);
+          // Every batch has its own stream, whatever the number of threads.
+          u64 state = options.seed ^ (firstBatch * 0xD1B54A32D192ED03);
+          for (u32 k = 0; k < batches; ++k) {
+            for (usize i = 0; i < inputCount; ++i) {
+              words[k * inputCount + i] = options.mode == Mode::Gray ? grayWord(firstBatch + k, (u32)i) : splitMix(state);
+            }
+          }
+
+          auto& engine = engines[chunk];
+          engine.simulate(Slice<const u64>(words.data(), words.size()));
+          // Without inputs there is a single batch.
+          auto& values = engine.getSimulatedWords();
+          const usize stride = netCount == 0 ? 0 : values.size() / netCount;
+          for (u32 net = 0; net < netCount; ++net) {
+            u64 high = 0;
+            u64 low = 0;
+            for (usize k = 0; k < stride; ++k) {
+              high |= values[net * stride + k];
+              low  |= ~values[net * stride + k];
+            }
+            seenHigh[chunk][net] |= high != 0;
+            seenLow[chunk][net]  |= low != 0;
+          }
+        }
+      });
+      batch += roundBatches;
+      report.vectorCount += u64(roundBatches) * 64;
+
+      u32 toggledCount = 0;
+      for (u32 net = 0; net < netCount; ++net) {
+        bool high = false;
+        bool low = false;
+        for (u32 chunk = 0; chunk < chunkCount; ++chunk) {
+          high |= seenHigh[chunk][net];
+          low  |= seenLow[chunk][net];
+        }
+        report.toggled[net] = driven[net] && high && low;
+        toggledCount += report.toggled[net];
+      }
+
+      staleRounds = toggledCount == report.toggledCount ? staleRounds + 1 : 0;
+      report.toggledCount = toggledCount;
+      if (report.toggledCount == report.netCount) {
+        break;
+      }
+      if (options.mode == Mode::Gray && report.vectorCount >= combinations) {
+        report.exhausted = true;
+        break;
+      }
+      if (options.mode == Mode::Random && staleRounds >= options.patience) {
+        report.saturated = true;
+        break;
+      }
+    }
+    return report;
+  }
+
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "Core/Base.hpp"
+#include "Simulation/Netlist.hpp"
+
+#include <vector>
+
+namespace Gate::Simulation {
+
+  // Drives generated input vectors through Engine::simulate() and measures toggle coverage,
+  // a net is toggled once it has been seen both low and high.
+  //
+  // The vectors are simulated in rounds, every thread of the pool runs its own engine on a part
+  // of the round. The generation stops when every net has toggled, when the coverage hasn't
+  // grown for a few rounds (it saturated), or after the maximum number of vectors.
+  class StimulusGenerator {
+  public:
+    enum class Mode : u8 {
+      Random,
+
+      // Vector i is the Gray code of i, so consecutive vectors differ by one input. Inputs past
+      // the 64th stay low. The high inputs only change after many vectors, so the coverage isn't
+      // considered saturated, the generation stops once every combination has been applied.
+      Gray,
+    };
+
+    // Batches of 64 vectors run by a thread in a round, one full pass of the engine.
+    static const constexpr u32 BATCHES_PER_THREAD = 16;
+
+    struct Options {
+      Mode mode = Mode::Random;
+      u64 seed = 1;
+      u64 maxVectors = u64(1) << 24;
+
+      // Rounds without new toggled nets before the coverage is considered saturated.
+      u32 patience = 8;
+    };
+
+    struct Report {
+      u64 vectorCount = 0;
+
+      // Inputs and nets driven by an instruction, the others can't toggle.
+      u32 netCount = 0;
+      u32 toggledCount = 0;
+      std::vector<u8> toggled;
+
+      bool saturated = false;
+      bool exhausted = false;
+
+      inline f64 getCoverage() const { return netCount == 0 ? 1.0 : f64(toggledCount) / f64(netCount); }
+    };
+
+  public:
+    static Report run(const Netlist& netlist, const Options& options);
+  };
+
+}
@@ -0,0 +1,224 @@
+#include "Simulation/Timing.hpp"
+
+#include <algorithm>
+
+namespace Gate::Simulation {
+
+  void TimingEngine::load(const Netlist& netlist) {
+    mNetlist = &netlist;
+
+    const u32 netCount = netlist.getNetCount();
+    const u32 instructionCount = (u32)netlist.getInstructions().size();
+    mValues.assign(netCount, 0);
+    mProjected.assign(netCount, 0);
+
+    // The wheel has to be longer than the longest delay, so an event never laps the current time.
+    u32 maxDelay = 0;
+    for (auto delay : netlist.getDelays()) {
+      maxDelay = std::max(maxDelay, delay);
+    }
+    for (auto& reg : netlist.getRegisters()) {
+      maxDelay = std::max(maxDelay, reg.delay);
+    }
+    usize wheelSize = 1;
+    while (wheelSize <= maxDelay) {
+      wheelSize *= 2;
+    }
+    mWheel.assign(wheelSize, {});
+    mTime = 0;
+    mPendingCount = 0;
+    mEventCount = 0;
+
+    auto& memories = netlist.getMemories();
+    mMemoryContents.resize(memories.size());
+    for (u32 i = 0; i < memories.size(); ++i) {
+      mMemoryContents[i] = memories[i].getInitialContents();
+    }
+
+    mChangeTimes.assign(netCount, NEVER);
+    mChangeCounts.assign(netCount, 0);
+    mChanged.clear();
+    mChangedFlags.assign(netCount, 0);
+
+    // Power on, the instructions whose output isn't low are scheduled at their delay.
+    mActive.resize(instructionCount);
+    for (u32 i = 0; i < instructionCount; ++i) {
+      mActive[i] = i;
+    }
+    mActiveFlags.assign(instructionCount, 1);
+  }
+
+  bool TimingEngine::compute(const Instruction& instruction) const {
+    const u8* values = mValues.data();
+    switch (instruction.opcode) {
+      case Opcode::And:    return values[instruction.a] & values[instruction.b];
+      case Opcode::Or:     return values[instruction.a] | values[instruction.b];
+      case Opcode::Xor:    return values[instruction.a] ^ values[instruction.b];
+      case Opcode::Not:    return !values[instruction.a];
+      case Opcode::Buffer: return values[instruction.a];
+      case Opcode::Merge: {
+        const NetId* operands = mNetlist->getOperands().data() + instruction.a;
+        for (u32 i = 0; i < instruction.b; ++i) {
+          if (values[operands[i]]) {
+            return true;
+          }
+        }
+        return false;
+      }
+      case Opcode::Lookup: {
+        auto& lookup = mNetlist->getLookups()[instruction.a];
+        u32 index = 0;
+        for (u32 i = 0; i < lookup.inputs.size(); ++i) {
+          index |= u32(values[lookup.inputs[i]]) << i;
+        }
+        return lookup.table->get(instruction.b, index);
+      }
+      case Opcode::Read: {
+        auto& memory = mNetlist->getMemories()[instruction.a];
+        return (Memory::readWord(mMemoryContents[instruction.a].data(), memory.dataWidth, (u32)getWord(memory.address)) >> instruction.b) & 1;
+      }
+    }
+    GATE_UNREACHABLE("unknown opcode");
+  }
+
+  void TimingEngine::schedule(NetId net, bool value, Time delay) {
+    mProjected[net] = value;
+    mWheel[(mTime + delay) & (mWheel.size() - 1)].push_back(Event{net, value});
+    mPendingCount++;
+  }
+
+  u64 TimingEngine::getWord(const std::vector<NetId>& nets) const {
+    u64 word = 0;
+    for (u32 i = 0; i < nets.size(); ++i) {
+      word |= u64(mValues[nets[i]]) << i;
+    }
+    return word;
+  }
+
+  void TimingEngine::write(u32 memoryIndex) {
+    auto& memory = mNetlist->getMemories()[memoryIndex];
+    if (!mValues[memory.write]) {
+      return;
+    }
+    u8* contents = mMemoryContents[memoryIndex].data();
+    const u32 index = (u32)getWord(memory.address);
+    const u64 value = getWord(memory.data);
+    if (Memory::readWord(contents, memory.dataWidth, index) == value) {
+      return;
+    }
+    Memory::writeWord(contents, memory.dataWidth, index, value);
+    for (auto it = mNetlist->readersBegin(memoryIndex); it != mNetlist->readersEnd(memoryIndex); ++it) {
+      if (!mActiveFlags[*it]) {
+        mActiveFlags[*it] = 1;
+        mActive.push_back(*it);
+      }
+    }
+  }
+
+  void TimingEngine::setInput(u32 index, bool value) {
+    NetId net = mNetlist->getInputs()[index];
+    if (mProjected[net] != value) {
+      schedule(net, value, 0);
+    }
+  }
+
+  void TimingEngine::dispatch() {
+    auto& instructions = mNetlist->getInstructions();
+    auto& delays = mNetlist->getDelays();
+    auto& slot = mWheel[mTime & (mWheel.size() - 1)];
+
+    // Zero delay instructions schedule into the current slot, they are handled in delta cycles.
+    auto& events = mEvents;
+    for (u32 cycle = 0; !slot.empty() || !mActive.empty(); ++cycle) {
+      if (cycle == MAX_DELTA_CYCLES) {
+        Logger::warn("Timing: zero delay loop is oscillating at time %llu", (unsigned long long)mTime);
+        mPendingCount -= slot.size();
+        slot.clear();
+        for (auto index : mActive) {
+          mActiveFlags[index] = 0;
+        }
+        mActive.clear();
+        break;
+      }
+
+      events.swap(slot);
+      for (auto& event : events) {
+        mPendingCount--;
+        mEventCount++;
+        if (mValues[event.net] == event.value) {
+          continue;
+        }
+        mValues[event.net] = event.value;
+        mChangeTimes[event.net] = mTime;
+        mChangeCounts[event.net]++;
+        if (!mChangedFlags[event.net]) {
+          mChangedFlags[event.net] = 1;
+          mChanged.push_back(event.net);
+        }
+        for (auto it = mNetlist->fanoutBegin(event.net); it != mNetlist->fanoutEnd(event.net); ++it) {
+          if (!mActiveFlags[*it]) {
+            mActiveFlags[*it] = 1;
+            mActive.push_back(*it);
+          }
+        }
+
+        // Registers sample their input at the rising edge of their clock, memories are written
+        // right away and their reads take the delay of the Read instructions.
+        if (event.value) {
+          for (auto it = mNetlist->clockedRegistersBegin(event.net); it != mNetlist->clockedRegistersEnd(event.net); ++it) {
+            auto& reg = mNetlist->getRegisters()[*it];
+            if (mValues[reg.d] != mProjected[reg.q]) {
+              schedule(reg.q, mValues[reg.d], reg.delay);
+            }
+          }
+          for (auto it = mNetlist->clockedMemoriesBegin(event.net); it != mNetlist->clockedMemoriesEnd(event.net); ++it) {
+            write(*it);
+          }
+        }
+      }
+      events.clear();
+
+      for (auto index : mActive) {
+        mActiveFlags[index] = 0;
+        auto& instruction = instructions[index];
+        bool value = compute(instruction);
+        if (value != mProjected[instruction.output]) {
+          schedule(instruction.output, value, delays[index]);
+        }
+      }
+      mActive.clear();
+    }
+  }
+
+  void TimingEngine::advance(Time duration) {
+    for (auto net : mChanged) {
+      mChangedFlags[net] = 0;
+    }
+    mChanged.clear();
+
+    const Time end = mTime + duration;
+    while (mTime < end) {
+      if (isSettled()) {
+        mTime = end;
+        break;
+      }
+      dispatch();
+      mTime++;
+    }
+  }
+
+  bool TimingEngine::settle(Time limit) {
+    for (auto net : mChanged) {
+      mChangedFlags[net] = 0;
+    }
+    mChanged.clear();
+
+    const Time end = mTime + limit;
+    while (!isSettled() && mTime < end) {
+      dispatch();
+      mTime++;
+    }
+    return isSettled();
+  }
+
+}
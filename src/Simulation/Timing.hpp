@@ -0,0 +1,93 @@
+#pragma once
+
+#include "Core/Base.hpp"
+#include "Simulation/Netlist.hpp"
+
+#include <vector>
+
+namespace Gate::Simulation {
+
+  using Time = u64;
+
+  // Event driven simulation of a netlist where every instruction has a delay (see
+  // Netlist::Builder::setDelay()), unlike Engine which only computes the settled values.
+  //
+  // Changes are scheduled on a timing wheel with a slot per time unit, big enough for the
+  // longest delay, so scheduling and dispatching an event is O(1). Delays are transport
+  // delays, so pulses shorter than a gate delay (glitches) are propagated too.
+  class TimingEngine {
+  public:
+    static const constexpr Time NEVER = UINT64_MAX;
+
+    // Events dispatched in a single time unit, before zero delay feedback is considered
+    // to be oscillating and the remaining events are dropped.
+    static const constexpr u32 MAX_DELTA_CYCLES = 1024;
+
+  public:
+    // All the nets start low and every instruction is evaluated at time 0.
+    void load(const Netlist& netlist);
+
+    // The change is applied at the current time.
+    void setInput(u32 index, bool value);
+
+    // Dispatches the events of the next duration time units.
+    void advance(Time duration);
+
+    // Runs until there are no more pending events, or limit time units have passed.
+    // Returns true if the netlist has settled.
+    bool settle(Time limit);
+
+    inline const Netlist& getNetlist() const { return *mNetlist; }
+    inline Time getTime() const { return mTime; }
+    inline bool isSettled() const { return mPendingCount == 0 && mActive.empty(); }
+    inline bool getValue(NetId net) const { return mValues[net]; }
+
+    // Time of the last change of a net, NEVER if it hasn't changed since load().
+    inline Time getChangeTime(NetId net) const { return mChangeTimes[net]; }
+    inline u32 getChangeCount(NetId net) const { return mChangeCounts[net]; }
+
+    // Nets that have changed during the last advance() or settle() call.
+    inline const std::vector<NetId>& getChangedNets() const { return mChanged; }
+
+    inline u64 getEventCount() const { return mEventCount; }
+
+  private:
+    struct Event {
+      NetId net;
+      u8 value;
+    };
+
+  private:
+    bool compute(const Instruction& instruction) const;
+    void schedule(NetId net, bool value, Time delay);
+    void dispatch();
+    void write(u32 memory);
+    u64 getWord(const std::vector<NetId>& nets) const;
+
+  private:
+    const Netlist* mNetlist = nullptr;
+    std::vector<u8> mValues;
+
+    // Value of every net once its pending events have been applied
+    std::vector<u8> mProjected;
+
+    std::vector<std::vector<u8>> mMemoryContents;
+
+    // Timing wheel, slot i has the events of the times t with t % size == i.
+    std::vector<std::vector<Event>> mWheel;
+    std::vector<Event> mEvents;
+    Time mTime = 0;
+    u64 mPendingCount = 0;
+    u64 mEventCount = 0;
+
+    // Instructions to evaluate at the current time, each one only once.
+    std::vector<u32> mActive;
+    std::vector<u8> mActiveFlags;
+
+    std::vector<Time> mChangeTimes;
+    std::vector<u32> mChangeCounts;
+    std::vector<NetId> mChanged;
+    std::vector<u8> mChangedFlags;
+  };
+
+}
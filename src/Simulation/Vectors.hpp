@@ -0,0 +1,31 @@
+#pragma once
+
+#include "Core/Base.hpp"
+
+namespace Gate::Simulation {
+
+  // Generation of the input vectors of the bit-parallel simulations, bit i of a word belongs
+  // to the vector i of its batch (see Engine::simulate()).
+
+  // SplitMix64, a word of random vectors.
+  inline u64 splitMix(u64& state) {
+    u64 z = (state += 0x9E3779B97F4A7C15);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+    return z ^ (z >> 31);
+  }
+
+  // Bit j of the vector index, for the 64 vectors of a batch.
+  inline u64 indexBits(u64 batch, u32 j) {
+    // The low bits are the lane, bit j is set in the lanes that have bit j of their index set.
+    static const constexpr u64 LANE_BITS[6] = {
+      0xAAAAAAAAAAAAAAAA, 0xCCCCCCCCCCCCCCCC, 0xF0F0F0F0F0F0F0F0,
+      0xFF00FF00FF00FF00, 0xFFFF0000FFFF0000, 0xFFFFFFFF00000000,
+    };
+    if (j < 6) {
+      return LANE_BITS[j];
+    }
+    return j < 64 && (batch >> (j - 6)) & 1 ? ~u64(0) : 0;
+  }
+
+}
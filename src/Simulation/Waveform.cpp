@@ -0,0 +1,155 @@
+#include "Simulation/Waveform.hpp"
+#include "Utils/File.hpp"
+
+#include <algorithm>
+
+namespace Gate::Simulation {
+
+  namespace {
+    // Short identifiers made of the printable characters, as most VCD writers do.
+    void appendIdentifier(String& output, u32 index) {
+      do {
+        output.push_back(char('!' + index % 94));
+        index /= 94;
+      } while (index != 0);
+    }
+
+    // VCD references can't have whitespace.
+    void appendReference(String& output, const StringView& name) {
+      if (name.empty()) {
+        output += "unnamed";
+        return;
+      }
+      for (char c : name) {
+        output.push_back(c == ' ' || c == '\t' || c == '\n' || c == '\r' ? '_' : c);
+      }
+    }
+
+    // Transposes a 64x64 bit matrix in place, bit j of row i becomes bit i of row j.
+    void transpose(u64 rows[64]) {
+      u64 mask = 0x00000000FFFFFFFF;
+      for (u32 j = 32; j != 0; j >>= 1, mask ^= mask << j) {
+        for (u32 k = 0; k < 64; k = (k + j + 1) & ~j) {
+          u64 t = ((rows[k] >> j) ^ rows[k + j]) & mask;
+          rows[k]     ^= t << j;
+          rows[k + j] ^= t;
+        }
+      }
+    }
+  }
+
+  void Waveform::setSignals(std::vector<String> names, u32 capacity) {
+    GATE_ASSERT(capacity > 0 && capacity <= (1u << 31));
+    u32 size = 1;
+    while (size < capacity) {
+      size *= 2;
+    }
+    if (names == mNames && size == mCapacity) {
+      return;
+    }
+    mNames = std::move(names);
+    mStride = 1 + ((u32)mNames.size() + 63) / 64;
+    mCapacity = size;
+    mSamples.assign((usize)mStride * mCapacity, 0);
+    mWriteIndex = 0;
+  }
+
+  void Waveform::clear() {
+    mWriteIndex = 0;
+  }
+
+  void Waveform::recordLanes(Time time, u32 laneCount, const u64* words) {
+    GATE_ASSERT(laneCount <= 64);
+    if (mCapacity == 0) {
+      return;
+    }
+    const u64 index = mWriteIndex;
+    for (u32 lane = 0; lane < laneCount; ++lane) {
+      mSamples[((index + lane) & (mCapacity - 1)) * mStride] = time + lane;
+    }
+
+    // A block of 64 signals at a time, the words are turned into one word per sample.
+    const u32 signalCount = (u32)mNames.size();
+    u64 block[64];
+    for (u32 first = 0; first < signalCount; first += 64) {
+      const u32 count = std::min<u32>(64, signalCount - first);
+      std::copy(words + first, words + first + count, block);
+      std::fill(block + count, block + 64, 0);
+      transpose(block);
+      for (u32 lane = 0; lane < laneCount; ++lane) {
+        mSamples[((index + lane) & (mCapacity - 1)) * mStride + 1 + first / 64] = block[lane];
+      }
+    }
+    mWriteIndex = index + laneCount;
+  }
+
+  u64 Waveform::copySamples(std::vector<u64>& samples) const {
+    const u64 end = mWriteIndex;
+    const u64 begin = end > mCapacity ? end - mCapacity : 0;
+    samples.resize((end - begin) * mStride);
+    for (u64 i = begin; i < end; ++i) {
+      auto* sample = mSamples.data() + (i & (mCapacity - 1)) * mStride;
+      std::copy(sample, sample + mStride, samples.data() + (i - begin) * mStride);
+    }
+    return begin;
+  }
+
+  void Waveform::writeVcd(String& output, const StringView& scope) const {
+    std::vector<u64> samples;
+    copySamples(samples);
+
+    output.clear();
+    output += "$version gate $end\n";
+    output += "$comment one time unit per tick or half cycle of the clocks, or per unit of delay in timing mode $end\n";
+    output += "$timescale 1ns $end\n";
+    output += "$scope module ";
+    appendReference(output, scope);
+    output += " $end\n";
+    for (u32 i = 0; i < mNames.size(); ++i) {
+      output += "$var wire 1 ";
+      appendIdentifier(output, i);
+      output += ' ';
+      appendReference(output, mNames[i]);
+      output += " $end\n";
+    }
+    output += "$upscope $end\n";
+    output += "$enddefinitions $end\n";
+
+    const usize count = samples.size() / mStride;
+    const u64* previous = nullptr;
+    for (usize s = 0; s < count; ++s) {
+      const u64* sample = samples.data() + s * mStride;
+      if (previous && std::equal(sample + 1, sample + mStride, previous + 1)) {
+        continue;
+      }
+      if (!previous || previous[0] != sample[0]) {
+        output += '#';
+        output += std::to_string(sample[0]);
+        output += '\n';
+      }
+      if (!previous) {
+        output += "$dumpvars\n";
+      }
+      for (u32 i = 0; i < mNames.size(); ++i) {
+        const bool value = (sample[1 + i / 64] >> (i % 64)) & 1;
+        if (previous && value == bool((previous[1 + i / 64] >> (i % 64)) & 1)) {
+          continue;
+        }
+        output.push_back(value ? '1' : '0');
+        appendIdentifier(output, i);
+        output += '\n';
+      }
+      if (!previous) {
+        output += "$end\n";
+      }
+      previous = sample;
+    }
+  }
+
+  bool Waveform::exportVcd(const String& path, const StringView& scope) const {
+    String output;
+    writeVcd(output, scope);
+    return Utils::stringToFile(path, output);
+  }
+
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "Core/Base.hpp"
+#include "Simulation/Timing.hpp"
+
+#include <vector>
+
+namespace Gate::Simulation {
+
+  // Records the values of a set of signals, one bit each, into a ring buffer that is allocated
+  // up front, so recording never allocates and the oldest samples are overwritten once it is full.
+  //
+  // NOTE: It is not thread safe, the samples have to be recorded and read on the same thread.
+  class Waveform {
+  public:
+    static const constexpr u32 DEFAULT_CAPACITY = 1 << 16;
+
+  public:
+    // Clears the samples when the signals are not the same as the recorded ones. The capacity
+    // is rounded up to a power of two.
+    void setSignals(std::vector<String> names, u32 capacity = DEFAULT_CAPACITY);
+    void clear();
+
+    // values(i) is the value of the i-th signal.
+    template<typename Values>
+    void record(Time time, const Values& values) {
+      if (mCapacity == 0) {
+        return;
+      }
+      const u64 index = mWriteIndex;
+      u64* sample = mSamples.data() + (index & (mCapacity - 1)) * mStride;
+      sample[0] = time;
+      for (u32 word = 1; word < mStride; ++word) {
+        sample[word] = 0;
+      }
+      for (u32 i = 0; i < (u32)mNames.size(); ++i) {
+        sample[1 + i / 64] |= u64(values(i) ? 1 : 0) << (i % 64);
+      }
+      mWriteIndex = index + 1;
+    }
+
+    // Records laneCount <= 64 samples at once from bit-parallel words (as in Engine::simulate()),
+    // lane k of words[i] is the value of the i-th signal at time + k.
+    void recordLanes(Time time, u32 laneCount, const u64* words);
+
+    // Writes the recorded samples as a value change dump, only the changes are written.
+    void writeVcd(String& output, const StringView& scope) const;
+    bool exportVcd(const String& path, const StringView& scope) const;
+
+    inline const std::vector<String>& getSignals() const { return mNames; }
+    inline u32 getCapacity() const { return mCapacity; }
+    inline u64 getRecordedCount() const { return mWriteIndex; }
+    inline u64 getOverwrittenCount() const {
+      u64 count = getRecordedCount();
+      return count > mCapacity ? count - mCapacity : 0;
+    }
+
+  private:
+    // Copies the samples that are still in the buffer, returns the index of the first one.
+    u64 copySamples(std::vector<u64>& samples) const;
+
+  private:
+    std::vector<String> mNames;
+
+    // A sample is its time followed by a bit per signal.
+    u32 mStride = 1;
+    u32 mCapacity = 0;
+    std::vector<u64> mSamples;
+    u64 mWriteIndex = 0;
+  };
+
+}
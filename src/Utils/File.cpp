@@ -29,4 +29,60 @@ namespace Gate::Utils {
     return buffer;
   }
 
+  bool fileToBytes(const StringView& filename, std::vector<u8>& bytes) {
+    FILE* f = fopen(filename.data(), "rb");
+    if (!f) {
+      Logger::error("Couldn't open file '%.*s': %s", filename.size(), filename.data(), strerror(errno));
+      return false;
+    }
+
+    fseek(f, 0, SEEK_END);
+    long end = ftell(f);
+    if (end < 0) {
+      Logger::error("Couldn't read file '%.*s': %s", filename.size(), filename.data(), strerror(errno));
+      fclose(f);
+      return false;
+    }
+    usize length = (usize)end;
+    fseek(f, 0, SEEK_SET);
+    bytes.resize(length);
+    bool read = fread(bytes.data(), sizeof(u8), length, f) == length;
+    if (!read) {
+      Logger::error("Couldn't read file '%.*s': %s", filename.size(), filename.data(), strerror(errno));
+    }
+    fclose(f);
+    return read;
+  }
+
+  bool stringToFile(const StringView& filename, const StringView& content) {
+    FILE* f = fopen(filename.data(), "w");
+    if (!f) {
+      Logger::error("Couldn't open file '%.*s': %s", filename.size(), filename.data(), strerror(errno));
+      return false;
+    }
+
+    bool written = fwrite(content.data(), sizeof(char), content.size(), f) == content.size();
+    if (!written) {
+      Logger::error("Couldn't write to file '%.*s': %s", filename.size(), filename.data(), strerror(errno));
+    }
+    fclose(f);
+    return written;
+  }
+
+  String parentDirectory(const StringView& filename) {
+    const auto separator = filename.find_last_of("/\\");
+    if (separator == StringView::npos) {
+      return String();
+    }
+    return String(filename.substr(0, separator + 1));
+  }
+
+  String resolvePath(const StringView& directory, const StringView& path) {
+    const bool absolute = (!path.empty() && (path[0] == '/' || path[0] == '\\')) || (path.size() > 1 && path[1] == ':');
+    if (absolute) {
+      return String(path);
+    }
+    return String(directory) + String(path);
+  }
+
 } // namespace Gate::Utils
\ No newline at end of file
@@ -2,8 +2,17 @@
 
 #include "Core/Type.hpp"
 
+#include <vector>
+
 namespace Gate::Utils {
 
   char* fileToString(const StringView& filename);
+  bool fileToBytes(const StringView& filename, std::vector<u8>& bytes);
+  bool stringToFile(const StringView& filename, const StringView& content);
+
+  // The directory of the file, with its trailing separator ("" for a file of the working directory).
+  String parentDirectory(const StringView& filename);
+  // The path as seen from the directory, absolute paths are kept as is.
+  String resolvePath(const StringView& directory, const StringView& path);
 
 } // namespace Gate::Utils
@@ -0,0 +1,165 @@
+#include "Test.hpp"
+
+#include "Editor/Chip.hpp"
+#include "Editor/Components.hpp"
+#include "Serializer/Serializer.hpp"
+#include "Simulation/Vectors.hpp"
+#include "Utils/File.hpp"
+
+namespace {
+
+  using namespace Gate;
+  using namespace Gate::Serializer;
+
+  bool loadChips(const String& path, std::vector<Chip::Handle>& chips) {
+    char* content = Utils::fileToString(path);
+    if (!content) {
+      return false;
+    }
+    auto node = Json::parse(content);
+    free(content);
+    if (!node || !node->get("chips") || !node->get("chips")->isArray()) {
+      return false;
+    }
+    const auto directory = Utils::parentDirectory(path);
+    for (auto& chipNode : *node->get("chips")->asArray()) {
+      auto chip = Chip::create((u32)chips.size());
+      if (!Convert<Chip>::decode(chipNode, *chip, chips, directory)) {
+        return false;
+      }
+      chips.push_back(std::move(chip));
+    }
+    return true;
+  }
+
+  // The outputs for every input vector, the chips of the tests have at most 6 inputs so they
+  // fit in a single batch.
+  std::vector<u64> truthTable(Chip& chip) {
+    std::vector<u64> inputs;
+    for (u32 i = 0; i < chip.getInputCount(); ++i) {
+      inputs.push_back(Simulation::indexBits(0, i));
+    }
+    return chip.simulateVectors(Slice<const u64>(inputs.data(), inputs.size()));
+  }
+
+  // The sum (a ^ b) and the carry (a & b) of two switches, the switches branch out to both gates.
+  void buildHalfAdder(Chip& chip) {
+    chip.pushComponent(new SwitchComponent(Point{2, 2}));
+    chip.pushComponent(new SwitchComponent(Point{2, 4}));
+    chip.pushComponent(new XorComponent(Point{6, 3}));
+    chip.pushComponent(new AndComponent(Point{6, 7}));
+    chip.pushComponent(new OutputComponent(Point{10, 3}));
+    chip.pushComponent(new OutputComponent(Point{10, 7}));
+    chip.pushWire(Wire{Point{3, 2}, Point{4, 2}});
+    chip.pushWire(Wire{Point{4, 2}, Point{5, 2}});
+    chip.pushWire(Wire{Point{4, 2}, Point{4, 6}});
+    chip.pushWire(Wire{Point{4, 6}, Point{5, 6}});
+    chip.pushWire(Wire{Point{3, 4}, Point{5, 4}});
+    chip.pushWire(Wire{Point{3, 4}, Point{3, 8}});
+    chip.pushWire(Wire{Point{3, 8}, Point{5, 8}});
+    chip.pushWire(Wire{Point{7, 3}, Point{9, 3}});
+    chip.pushWire(Wire{Point{7, 7}, Point{9, 7}});
+  }
+
+  const Node* findComponent(const Node& chipNode, const char* type) {
+    for (auto& component : *chipNode.get("components")->asArray()) {
+      if (*component.get("type")->asString() == type) {
+        return &component;
+      }
+    }
+    return nullptr;
+  }
+
+}
+
+GATE_TEST(chipSimulatesHalfAdder) {
+  auto chip = Chip::create(0);
+  buildHalfAdder(*chip);
+  const auto outputs = truthTable(*chip);
+  GATE_CHECK(outputs.size() == 2);
+  GATE_CHECK((outputs[0] & 0xF) == 0b0110);
+  GATE_CHECK((outputs[1] & 0xF) == 0b1000);
+}
+
+GATE_TEST(chipRoundTrip) {
+  auto chip = Chip::create(0);
+  buildHalfAdder(*chip);
+  chip->setName("adder");
+  chip->setMemoized(true);
+  const auto json = Convert<Chip>::encode(*chip).toString();
+
+  auto node = Json::parse(json);
+  GATE_CHECK(node.has_value());
+  if (!node) {
+    return;
+  }
+  auto decoded = Chip::create(0);
+  GATE_CHECK(Convert<Chip>::decode(*node, *decoded, {}, ""));
+  GATE_CHECK(decoded->getName() == "adder");
+  GATE_CHECK(decoded->isMemoized());
+  GATE_CHECK(decoded->getComponents().size() == chip->getComponents().size());
+  GATE_CHECK(truthTable(*decoded) == truthTable(*chip));
+  GATE_CHECK(Convert<Chip>::encode(*decoded).toString() == json);
+}
+
+// The ROM file is resolved against the directory of the board, but encoded as it was written.
+GATE_TEST(romRoundTripKeepsPath) {
+  std::vector<Chip::Handle> chips;
+  GATE_CHECK(loadChips(Tests::dataPath("rom.json"), chips));
+  if (chips.size() != 1) {
+    return;
+  }
+
+  std::vector<u8> bytes;
+  GATE_CHECK(Utils::fileToBytes(Tests::dataPath("rom/program.bin"), bytes));
+  const auto outputs = truthTable(*chips[0]);
+  GATE_CHECK(outputs.size() == 8 && bytes.size() == 4);
+  for (u32 bit = 0; bit < outputs.size() && bytes.size() == 4; ++bit) {
+    for (u32 address = 0; address < 4; ++address) {
+      GATE_CHECK(((outputs[bit] >> address) & 1) == ((bytes[address] >> bit) & 1u));
+    }
+  }
+
+  const auto chipNode = Convert<Chip>::encode(*chips[0]);
+  const Node* romNode = findComponent(chipNode, "RomComponent");
+  GATE_CHECK(romNode && romNode->get("file") && *romNode->get("file")->asString() == "rom/program.bin");
+  if (!romNode) {
+    return;
+  }
+
+  // Without the contents, the file is loaded again, from the directory of the board only.
+  Node fileOnly = *romNode;
+  fileOnly.asObject()->erase("contents");
+  Gate::Component* rom = Gate::Component::decode(fileOnly, chips, Utils::parentDirectory(Tests::dataPath("rom.json")));
+  GATE_CHECK(rom != nullptr);
+  delete rom;
+  rom = Gate::Component::decode(fileOnly, chips, Tests::dataPath("rom/"));
+  GATE_CHECK(rom == nullptr);
+  delete rom;
+
+  // With the contents, the board doesn't need the file anymore.
+  auto node = Json::parse(chipNode.toString());
+  auto decoded = Chip::create(0);
+  GATE_CHECK(node && Convert<Chip>::decode(*node, *decoded, {}, ""));
+  GATE_CHECK(truthTable(*decoded) == outputs);
+  GATE_CHECK(Convert<Chip>::encode(*decoded).toString() == chipNode.toString());
+}
+
+// Adding and removing components and wires leaves no stale connection points behind.
+GATE_TEST(chipCompactsConnections) {
+  auto chip = Chip::create(0);
+  chip->pushComponent(new SwitchComponent(Point{1, 1}));
+  chip->pushComponent(new NotComponent(Point{4, 1}));
+  chip->pushComponent(new OutputComponent(Point{7, 1}));
+  chip->pushWire(Wire{Point{2, 1}, Point{3, 1}});
+  chip->pushWire(Wire{Point{5, 1}, Point{6, 1}});
+  for (u32 i = 0; i < 100; ++i) {
+    chip->pushComponent(new NotComponent(Point{4, 5}));
+    chip->pushWire(Wire{Point{3, 5}, Point{3, 8}});
+    chip->removeWire(Point{3, 6});
+    chip->removeComponent(Point{4, 5});
+  }
+  const auto outputs = truthTable(*chip);
+  GATE_CHECK(outputs.size() == 1);
+  GATE_CHECK((outputs[0] & 0b11) == 0b01);
+}
@@ -0,0 +1,59 @@
+#include "Test.hpp"
+
+#include <cstring>
+
+// Runs every test, or the ones whose name is given. The exit code is the number of failed tests.
+namespace {
+
+  using namespace Gate;
+
+  struct Test {
+    const char* name;
+    Tests::TestFunction function;
+  };
+
+  std::vector<Test>& getTests() {
+    static std::vector<Test> tests;
+    return tests;
+  }
+
+  u32 gFailedChecks = 0;
+
+}
+
+namespace Gate::Tests {
+
+  Registration::Registration(const char* name, TestFunction function) {
+    getTests().push_back(Test{name, function});
+  }
+
+  void fail(const char* file, int line, const char* expression) {
+    fprintf(stderr, "%s:%d: check failed '%s'\n", file, line, expression);
+    gFailedChecks++;
+  }
+
+  String dataPath(const char* path) {
+    return String(GATE_TESTS_DATA_DIRECTORY) + "/" + path;
+  }
+
+}
+
+int main(int argc, char** argv) {
+  int failed = 0;
+  for (auto& test : getTests()) {
+    bool selected = argc < 2;
+    for (int i = 1; i < argc; ++i) {
+      selected |= strcmp(argv[i], test.name) == 0;
+    }
+    if (!selected) {
+      continue;
+    }
+
+    const u32 failedChecks = gFailedChecks;
+    test.function();
+    const bool passed = gFailedChecks == failedChecks;
+    printf("%s %s\n", passed ? "ok  " : "FAIL", test.name);
+    failed += !passed;
+  }
+  return failed;
+}
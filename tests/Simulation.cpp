@@ -0,0 +1,199 @@
+#include "Test.hpp"
+
+#include "Simulation/Engine.hpp"
+#include "Simulation/Equivalence.hpp"
+#include "Simulation/Optimizer.hpp"
+#include "Simulation/Vectors.hpp"
+
+#include <algorithm>
+
+namespace {
+
+  using namespace Gate;
+  using namespace Gate::Simulation;
+
+  // A combinational netlist of random gates, with the redundancies the optimizer looks for
+  // (buffers, double inverters, duplicated gates and gates of the same operand twice). The
+  // gate at index mutation, if any, computes an or instead of an and (or the other way around).
+  Netlist randomNetlist(u64 seed, u32 inputCount, u32 gateCount, u32 outputCount, u32 mutation = UINT32_MAX) {
+    auto builder = Netlist::builder();
+    std::vector<NetId> nets;
+    for (u32 i = 0; i < inputCount; ++i) {
+      const NetId net = builder.addNet();
+      builder.addInput(net);
+      nets.push_back(net);
+    }
+
+    std::vector<Instruction> gates;
+    for (u32 i = 0; i < gateCount; ++i) {
+      Instruction gate;
+      gate.a = nets[splitMix(seed) % nets.size()];
+      gate.b = splitMix(seed) % 8 == 0 ? gate.a : nets[splitMix(seed) % nets.size()];
+      gate.output = builder.addNet();
+
+      const u64 kind = splitMix(seed) % 8;
+      if (kind == 0 && !gates.empty()) {
+        const auto& other = gates[splitMix(seed) % gates.size()];
+        gate.opcode = other.opcode;
+        gate.a = other.a;
+        gate.b = other.b;
+      } else {
+        constexpr Opcode OPCODES[] = {Opcode::And, Opcode::Or, Opcode::Xor, Opcode::Not, Opcode::Buffer, Opcode::And, Opcode::Or, Opcode::Xor};
+        gate.opcode = OPCODES[kind];
+      }
+      if (i == mutation) {
+        gate.opcode = gate.opcode == Opcode::And ? Opcode::Or : Opcode::And;
+      }
+
+      if (gate.opcode == Opcode::Not || gate.opcode == Opcode::Buffer) {
+        builder.addGate(gate.opcode, gate.a, gate.output);
+      } else {
+        builder.addGate(gate.opcode, gate.a, gate.b, gate.output);
+      }
+      gates.push_back(gate);
+      nets.push_back(gate.output);
+    }
+
+    // The last gates, so most of the netlist is observed.
+    for (u32 i = 0; i < outputCount; ++i) {
+      builder.addOutput(gates[gates.size() - 1 - i].output);
+    }
+    return builder.build();
+  }
+
+  std::vector<u64> randomInputs(u64 seed, const Netlist& netlist, usize batchCount) {
+    std::vector<u64> inputs(batchCount * netlist.getInputs().size());
+    for (auto& word : inputs) {
+      word = splitMix(seed);
+    }
+    return inputs;
+  }
+
+  // Every input vector, in order.
+  std::vector<u64> exhaustiveInputs(const Netlist& netlist) {
+    const u32 inputCount = (u32)netlist.getInputs().size();
+    const u64 batchCount = ((u64(1) << inputCount) + 63) / 64;
+    std::vector<u64> inputs;
+    for (u64 batch = 0; batch < batchCount; ++batch) {
+      for (u32 i = 0; i < inputCount; ++i) {
+        inputs.push_back(indexBits(batch, i));
+      }
+    }
+    return inputs;
+  }
+
+  std::vector<u64> simulate(const Netlist& netlist, const std::vector<u64>& inputs) {
+    Engine engine;
+    engine.load(netlist);
+    return engine.simulate(Slice<const u64>(inputs.data(), inputs.size()));
+  }
+
+  std::vector<u8> evaluate(const Netlist& netlist, const std::vector<u8>& vector) {
+    Engine engine;
+    engine.load(netlist);
+    for (u32 i = 0; i < vector.size(); ++i) {
+      engine.setInput(i, vector[i]);
+    }
+    engine.evaluate();
+    std::vector<u8> outputs;
+    for (auto net : netlist.getOutputs()) {
+      outputs.push_back(engine.getValue(net));
+    }
+    return outputs;
+  }
+
+}
+
+GATE_TEST(optimizerKeepsOutputs) {
+  for (u64 seed = 1; seed <= 32; ++seed) {
+    const auto netlist = randomNetlist(seed, 16, 200, 8);
+    Optimizer::Stats stats;
+    const auto optimized = Optimizer::optimize(netlist, {}, &stats);
+    GATE_CHECK(stats.optimizedInstructions < stats.instructions);
+
+    // Several batches, so the engine takes more than one pass.
+    const auto inputs = randomInputs(seed, netlist, 4 * Engine::MAX_STRIDE + 3);
+    GATE_CHECK(simulate(netlist, inputs) == simulate(optimized, inputs));
+  }
+}
+
+GATE_TEST(optimizerKeepsObservedNets) {
+  const auto netlist = randomNetlist(7, 12, 150, 4);
+  std::vector<NetId> observed;
+  for (NetId net = 12; net < netlist.getNetCount(); net += 5) {
+    observed.push_back(net);
+  }
+  const auto optimized = Optimizer::optimize(netlist, observed);
+
+  Engine engine;
+  Engine optimizedEngine;
+  engine.load(netlist);
+  optimizedEngine.load(optimized);
+  u64 state = 7;
+  for (u32 vector = 0; vector < 64; ++vector) {
+    for (u32 i = 0; i < 12; ++i) {
+      const bool value = splitMix(state) & 1;
+      engine.setInput(i, value);
+      optimizedEngine.setInput(i, value);
+    }
+    engine.evaluate();
+    optimizedEngine.evaluate();
+    for (auto net : observed) {
+      GATE_CHECK(engine.getValue(net) == optimizedEngine.getValue(net));
+    }
+  }
+}
+
+// The SAT proof is checked against the exhaustive simulation, just above the inputs that the
+// checker simulates exhaustively itself.
+GATE_TEST(satAgreesWithExhaustive) {
+  const u32 inputCount = EquivalenceChecker::EXHAUSTIVE_INPUTS + 1;
+  EquivalenceChecker::Options options;
+  options.randomVectors = 0;
+
+  u32 different = 0;
+  for (u64 seed = 1; seed <= 8; ++seed) {
+    const auto netlist = randomNetlist(seed, inputCount, 120, 6);
+    const auto mutated = randomNetlist(seed, inputCount, 120, 6, 120 - 1 - u32(seed % 12));
+    const auto inputs = exhaustiveInputs(netlist);
+    const bool equivalent = simulate(netlist, inputs) == simulate(mutated, inputs);
+    different += !equivalent;
+
+    auto report = EquivalenceChecker::check(netlist, mutated, options);
+    GATE_CHECK(report.method == EquivalenceChecker::Method::Sat);
+    GATE_CHECK(report.result == (equivalent ? EquivalenceChecker::Result::Equivalent : EquivalenceChecker::Result::Different));
+    if (report.result == EquivalenceChecker::Result::Different) {
+      GATE_CHECK(evaluate(netlist, report.counterexample) == report.outputsA);
+      GATE_CHECK(evaluate(mutated, report.counterexample) == report.outputsB);
+      GATE_CHECK(report.outputsA != report.outputsB);
+    }
+
+    report = EquivalenceChecker::check(netlist, Optimizer::optimize(netlist, {}), options);
+    GATE_CHECK(report.method == EquivalenceChecker::Method::Sat);
+    GATE_CHECK(report.result == EquivalenceChecker::Result::Equivalent);
+  }
+
+  // Both verdicts are exercised.
+  GATE_CHECK(different != 0 && different != 8);
+}
+
+GATE_TEST(restoreStateReportsChangedNets) {
+  const auto netlist = randomNetlist(3, 8, 60, 4);
+  Engine engine;
+  engine.load(netlist);
+  engine.evaluate();
+  std::vector<u64> state(engine.getStateWordCount());
+  engine.saveState(state.data());
+
+  engine.propagate(0, true);
+  const auto changed = engine.getChangedNets();
+  GATE_CHECK(!changed.empty());
+
+  engine.restoreState(state.data());
+  auto restored = engine.getChangedNets();
+  auto expected = changed;
+  std::sort(restored.begin(), restored.end());
+  std::sort(expected.begin(), expected.end());
+  GATE_CHECK(restored == expected);
+  GATE_CHECK(!engine.getValue(netlist.getInputs()[0]));
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "Core/Base.hpp"
+
+// A minimal test harness, the build has no exceptions: a failed check is reported and the test
+// goes on, the test fails if any of its checks did.
+//
+//   GATE_TEST(optimizerKeepsOutputs) {
+//     GATE_CHECK(a == b);
+//   }
+namespace Gate::Tests {
+
+  using TestFunction = void (*)();
+
+  // Adds the test to the ones run by main(), in the order of the static initializers.
+  struct Registration {
+    Registration(const char* name, TestFunction function);
+  };
+
+  void fail(const char* file, int line, const char* expression);
+
+  // Path of a file in tests/data, the boards and the ROM files of the tests.
+  String dataPath(const char* path);
+
+}
+
+#define GATE_TEST(name)                                                          \
+  static void name();                                                            \
+  static const Gate::Tests::Registration name##Registration(#name, name);        \
+  static void name()
+
+#define GATE_CHECK(cond) do { if (!(cond)) { Gate::Tests::fail(__FILE__, __LINE__, #cond); } } while(false)